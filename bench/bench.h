@@ -0,0 +1,41 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+// Minimal helpers shared by the benchmark executables. Each benchmark accepts
+// --quick to run a few iterations only (used by ctest as a smoke test).
+namespace bench {
+
+    inline bool quick_mode(int argc, char** argv) {
+        for (int i = 1; i < argc; ++i) {
+            if (std::strcmp(argv[i], "--quick") == 0) return true;
+        }
+        return false;
+    }
+
+    // Keeps `value` alive so the optimizer cannot drop the work that produced it.
+    template <typename T>
+    inline void do_not_optimize(const T& value) {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    // Runs fn() `iters` times after a short warmup and returns nanoseconds per call.
+    template <typename Fn>
+    double ns_per_op(std::size_t iters, Fn&& fn) {
+        for (std::size_t i = 0; i < iters / 10 + 1; ++i) fn();
+
+        const auto t0 = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < iters; ++i) fn();
+        const auto t1 = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::nano>(t1 - t0).count() / static_cast<double>(iters);
+    }
+
+    inline void report(const std::string& name, double ns_per_op, const char* unit = "op") {
+        std::printf("%-48s %12.1f ns/%s\n", name.c_str(), ns_per_op, unit);
+    }
+
+} // namespace bench
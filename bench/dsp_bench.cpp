@@ -0,0 +1,148 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <numbers>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "app_config.h"
+#include "bench.h"
+#include "dsp_kernels.h"
+#include "logger.h"
+#include "waveform_channel.h"
+
+// Waveform feature extraction cost: each dsp kernel on one block, the FFT against a scalar
+// radix-2 reference, and the whole per-block pipeline as WaveformChannel runs it.
+
+namespace {
+
+    constexpr std::size_t kBlock = 4096;
+
+    // The straightforward radix-2 FFT (strided twiddles, one butterfly at a time), for comparison.
+    class ScalarFft {
+        public:
+            explicit ScalarFft(std::size_t n) : n_(n), tw_re_(n / 2), tw_im_(n / 2) {
+                for (std::size_t k = 0; k < n / 2; ++k) {
+                    const double angle = -2.0 * std::numbers::pi * static_cast<double>(k) / static_cast<double>(n);
+                    tw_re_[k] = static_cast<float>(std::cos(angle));
+                    tw_im_[k] = static_cast<float>(std::sin(angle));
+                }
+            }
+
+            // butterflies only; the bit-reversal pass is identical in both versions
+            void butterflies(float* re, float* im) const {
+                for (std::size_t len = 2; len <= n_; len <<= 1) {
+                    const std::size_t half = len / 2;
+                    const std::size_t stride = n_ / len;
+                    for (std::size_t base = 0; base < n_; base += len) {
+                        for (std::size_t k = 0; k < half; ++k) {
+                            const float wr = tw_re_[k * stride];
+                            const float wi = tw_im_[k * stride];
+                            const std::size_t a = base + k;
+                            const std::size_t b = a + half;
+                            const float tr = re[b] * wr - im[b] * wi;
+                            const float ti = re[b] * wi + im[b] * wr;
+                            re[b] = re[a] - tr;
+                            im[b] = im[a] - ti;
+                            re[a] += tr;
+                            im[a] += ti;
+                        }
+                    }
+                }
+            }
+
+        private:
+            std::size_t n_;
+            std::vector<float> tw_re_;
+            std::vector<float> tw_im_;
+    };
+
+    void report_per_sample(const char* name, double ns_per_block) {
+        bench::report(name, ns_per_block / static_cast<double>(kBlock), "sample");
+    }
+
+    // Runs a real channel with its producer unpaced and reports its own throughput figure.
+    void channel_throughput(std::size_t bands, std::uint64_t blocks) {
+        WaveformConfig cfg;
+        cfg.sample_rate_hz = 1'000'000'000; // producer effectively unpaced
+        cfg.block_size = static_cast<int>(kBlock);
+        cfg.noise = 0.1;
+        for (std::size_t b = 0; b < bands; ++b) {
+            const double lo = 1e6 * static_cast<double>(b + 1);
+            cfg.bands.emplace_back(lo, lo + 5e6);
+        }
+
+        WaveformChannel channel("vibration", "g", cfg);
+        channel.start();
+        WaveformFeatures features;
+        while (channel.blocks() < blocks) {
+            if (!channel.poll(features)) std::this_thread::yield();
+        }
+        channel.stop();
+
+        char name[96];
+        std::snprintf(name, sizeof(name), "WaveformChannel block, %zu bands", bands);
+        bench::report(name, 1e9 / channel.samples_per_s(), "sample");
+        std::printf("%-48s %12.1f M samples/s per core\n", "  = throughput", channel.samples_per_s() / 1e6);
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const bool quick = bench::quick_mode(argc, argv);
+    const std::size_t iters = quick ? 10 : 20000;
+    logger::set_level(logger::Level::Warn);
+
+    std::printf("kernels: %.*s, block %zu\n", static_cast<int>(dsp::isa().size()), dsp::isa().data(), kBlock);
+
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    std::vector<float> x(kBlock);
+    std::vector<float> y(kBlock);
+    std::vector<float> out(kBlock);
+    for (std::size_t i = 0; i < kBlock; ++i) {
+        x[i] = dist(rng);
+        y[i] = dist(rng);
+    }
+
+    report_per_sample("sum", bench::ns_per_op(iters, [&] { bench::do_not_optimize(dsp::sum(x.data(), kBlock)); }));
+    report_per_sample("sum_squares", bench::ns_per_op(iters, [&] { bench::do_not_optimize(dsp::sum_squares(x.data(), kBlock)); }));
+    report_per_sample("max_abs", bench::ns_per_op(iters, [&] { bench::do_not_optimize(dsp::max_abs(x.data(), kBlock)); }));
+    report_per_sample("multiply (window)", bench::ns_per_op(iters, [&] {
+        dsp::multiply(x.data(), y.data(), out.data(), kBlock);
+        bench::do_not_optimize(out.data());
+    }));
+    report_per_sample("power", bench::ns_per_op(iters, [&] {
+        dsp::power(x.data(), y.data(), out.data(), kBlock / 2 + 1);
+        bench::do_not_optimize(out.data());
+    }));
+
+    // the transform is run on the same buffers repeatedly; values stay finite because the
+    // inputs are reloaded every iteration
+    std::vector<float> re(kBlock);
+    std::vector<float> im(kBlock);
+    const dsp::Fft fft(kBlock);
+    const double fft_ns = bench::ns_per_op(iters, [&] {
+        re = x;
+        std::fill(im.begin(), im.end(), 0.0f);
+        fft.forward(re.data(), im.data());
+        bench::do_not_optimize(re.data());
+    });
+    report_per_sample("Fft::forward", fft_ns);
+
+    const ScalarFft scalar(kBlock);
+    const double scalar_ns = bench::ns_per_op(iters, [&] {
+        re = x;
+        std::fill(im.begin(), im.end(), 0.0f);
+        scalar.butterflies(re.data(), im.data());
+        bench::do_not_optimize(re.data());
+    });
+    report_per_sample("scalar butterflies (reference, no bit reversal)", scalar_ns);
+
+    channel_throughput(0, quick ? 3 : 2000);
+    channel_throughput(2, quick ? 3 : 2000);
+    return 0;
+}
@@ -0,0 +1,122 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <numeric>
+#include <string>
+#include <sys/mman.h>
+#include <thread>
+#include <vector>
+
+#include "bench.h"
+#include "latency_histogram.h"
+#include "logger.h"
+#include "realtime.h"
+
+// Wake-up jitter of a fixed-period loop shaped like run_loop, under background CPU and memory
+// load, for each step of the realtime settings in turn: nothing, lock_memory, a FIFO policy, and
+// (with more than one CPU) sampling_cpus. Same histogram as the health payload's `jitter`.
+//   jitter_bench [--quick] [--period-us 1000] [--seconds 10]
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    struct Options {
+        bool quick = false;
+        std::chrono::microseconds period {1000};
+        double seconds = 10.0;
+    };
+
+    Options parse(int argc, char** argv) {
+        Options opts;
+        opts.quick = bench::quick_mode(argc, argv);
+        for (int i = 1; i + 1 < argc; ++i) {
+            if (std::strcmp(argv[i], "--period-us") == 0) opts.period = std::chrono::microseconds(std::atol(argv[++i]));
+            else if (std::strcmp(argv[i], "--seconds") == 0) opts.seconds = std::atof(argv[++i]);
+        }
+        if (opts.quick) opts.seconds = 0.3;
+        return opts;
+    }
+
+    // Spins and churns pages so the loop competes for the CPU and for the page allocator.
+    void load(const std::atomic<bool>& stop) {
+        constexpr std::size_t kChurnBytes = 4 * 1024 * 1024;
+        while (!stop.load(std::memory_order_relaxed)) {
+            auto* block = static_cast<unsigned char*>(std::malloc(kChurnBytes));
+            if (block) {
+                for (std::size_t i = 0; i < kChurnBytes; i += 4096) block[i] = 1;
+                bench::do_not_optimize(block[kChurnBytes / 2]);
+                std::free(block);
+            }
+        }
+    }
+
+    // Sleeps to each deadline like run_loop and records how late it woke up. The body does a
+    // small allocation, as building a payload would.
+    LatencyHistogram run(const Options& opts) {
+        LatencyHistogram jitter;
+        const auto end = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(opts.seconds));
+        auto next_wake = Clock::now() + opts.period;
+        while (next_wake < end) {
+            std::this_thread::sleep_until(next_wake);
+            jitter.record(Clock::now() - next_wake);
+
+            std::vector<double> work(256, 1.0);
+            bench::do_not_optimize(std::accumulate(work.begin(), work.end(), 0.0));
+
+            next_wake += opts.period;
+            const auto now = Clock::now();
+            if (now - next_wake > opts.period) next_wake = now;
+        }
+        return jitter;
+    }
+
+    void report(const char* name, const LatencyHistogram& h) {
+        std::printf("%-32s p50 %6llu us  p99 %6llu us  max %6llu us  n=%llu\n", name,
+                    static_cast<unsigned long long>(h.percentile_us(50.0)), static_cast<unsigned long long>(h.percentile_us(99.0)),
+                    static_cast<unsigned long long>(h.max_us()), static_cast<unsigned long long>(h.count()));
+        std::string line = "    log2_us_buckets:";
+        for (std::size_t i = 0; i < LatencyHistogram::kBuckets; ++i) {
+            if (h.buckets()[i] == 0) continue;
+            line += " <" + std::to_string(std::uint64_t{1} << i) + ":" + std::to_string(h.buckets()[i]);
+        }
+        std::printf("%s\n", line.c_str());
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    logger::set_level(logger::Level::Off);
+    const auto opts = parse(argc, argv);
+
+    const unsigned cpus = std::max(1u, std::thread::hardware_concurrency());
+    std::printf("period %lld us, %.1f s per setting, %u CPU(s), %u load thread(s)\n",
+                static_cast<long long>(opts.period.count()), opts.seconds, cpus, cpus);
+
+    // started before any setting is applied, so they keep SCHED_OTHER and every CPU
+    std::atomic<bool> stop {false};
+    std::vector<std::thread> loaders;
+    for (unsigned i = 0; i < cpus; ++i) loaders.emplace_back([&stop] { load(stop); });
+
+    report("default", run(opts));
+
+    // each step keeps the previous ones
+    if (lock_and_prefault_memory(1024, 256)) report("lock_memory", run(opts));
+    else std::printf("%-32s not permitted (CAP_IPC_LOCK), skipped\n", "lock_memory");
+
+    if (set_thread_scheduling("fifo", 50)) report("+ sched fifo 50", run(opts));
+    else std::printf("%-32s not permitted (CAP_SYS_NICE), skipped\n", "+ sched fifo 50");
+
+    if (cpus > 1 && set_thread_affinity({static_cast<int>(cpus - 1)})) report("+ sampling_cpus [last]", run(opts));
+    else std::printf("%-32s needs more than one CPU, skipped\n", "+ sampling_cpus [last]");
+
+    stop = true;
+    for (auto& t : loaders) t.join();
+    set_thread_scheduling("other", 0);
+    munlockall();
+    return 0;
+}
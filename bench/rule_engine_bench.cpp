@@ -0,0 +1,90 @@
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "app_config.h"
+#include "bench.h"
+#include "rule_engine.h"
+
+// Cost of RuleEngine::evaluate() per sample, for rule sets of increasing size.
+// The sampling loop calls it once per reading, so compare against interval_ms / metrics.
+
+namespace {
+
+    std::vector<MetricConfig> make_metrics(std::size_t n) {
+        std::vector<MetricConfig> metrics(n);
+        for (std::size_t i = 0; i < n; ++i) metrics[i].name = "m" + std::to_string(i);
+        return metrics;
+    }
+
+    // Cycles through threshold, rate, band and band-with rules, spread over all metrics.
+    std::vector<RuleConfig> make_rules(std::size_t n, std::size_t metrics) {
+        std::vector<RuleConfig> rules(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            auto& rule = rules[i];
+            rule.name = "r" + std::to_string(i);
+            rule.metric = "m" + std::to_string(i % metrics);
+
+            switch (i % 4) {
+                case 0: rule.kind = "threshold"; rule.op = ">"; rule.value = 80.0; break;
+                case 1: rule.kind = "rate"; rule.op = ">"; rule.value = 5.0; break;
+                case 2: rule.kind = "band"; rule.low = 10.0; rule.high = 90.0; rule.for_ms = 100; break;
+                case 3:
+                    rule.kind = "band";
+                    rule.low = 20.0;
+                    rule.high = 70.0;
+                    rule.with_metric = "m" + std::to_string((i + 1) % metrics);
+                    rule.with_low = 30.0;
+                    rule.with_high = 60.0;
+                    break;
+            }
+        }
+        return rules;
+    }
+
+    void run(const char* label, std::size_t rule_count, std::size_t metric_count, std::size_t iters) {
+        const auto metrics = make_metrics(metric_count);
+        const auto rules = make_rules(rule_count, metric_count);
+        RuleEngine engine(rules, metrics);
+
+        std::vector<RuleEvent> events;
+        events.reserve(rule_count);
+
+        // a slow triangle wave that crosses every threshold, so transitions are part of the cost
+        auto now = RuleEngine::Clock::now();
+        std::size_t i = 0;
+        double value = 0.0;
+        double step = 0.37;
+
+        const double ns = bench::ns_per_op(iters, [&] {
+            value += step;
+            if (value > 100.0 || value < 0.0) step = -step;
+            now += std::chrono::milliseconds(1);
+
+            events.clear();
+            engine.evaluate(i++ % metric_count, value, now, events);
+            bench::do_not_optimize(events.size());
+        });
+
+        char name[96];
+        std::snprintf(name, sizeof(name), "%s (%zu rules, %zu metrics)", label, rule_count, metric_count);
+        bench::report(name, ns, "sample");
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::size_t iters = bench::quick_mode(argc, argv) ? 1000 : 5'000'000;
+
+    run("no rules", 0, 4, iters);
+    run("single threshold", 1, 1, iters);
+    run("mixed", 4, 4, iters);
+    run("mixed", 16, 4, iters);
+    run("mixed", 64, 8, iters);
+
+    // for scale: what timing every evaluation inline would add
+    const double clock_ns = bench::ns_per_op(iters, [] { bench::do_not_optimize(std::chrono::steady_clock::now()); });
+    bench::report("steady_clock::now()", clock_ns, "call");
+    return 0;
+}
@@ -0,0 +1,144 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "bench.h"
+#include "time_series_store.h"
+
+// Memory and query cost of TimeSeriesStore for the figures quoted in the README:
+// one hour of 1 Hz samples per metric, then full-hour range and downsample queries.
+
+namespace {
+
+    constexpr std::int64_t kStartMs = 1700000000000;
+    constexpr std::int64_t kHour = 3600;
+
+    // "temperature": a slow sine plus noise, quantized to 0.01 like a typical sensor driver.
+    double temperature(std::int64_t i, std::mt19937& rng) {
+        std::normal_distribution<double> noise(0.0, 0.05);
+        const double temp = 21.0 + 2.0 * std::sin(static_cast<double>(i) / 600.0) + noise(rng);
+        return std::round(temp * 100.0) / 100.0;
+    }
+
+    // "ramp": the simulated sensor from config_example.json (start * step * n).
+    double ramp(std::int64_t i) { return 20.0 * 0.25 * static_cast<double>(i); }
+
+    TimeSeriesStore make_store(std::int64_t seconds) {
+        TimeSeriesStore store({"temperature", "ramp"}, std::chrono::hours(6));
+        std::mt19937 rng(42);
+        for (std::int64_t i = 0; i < seconds; ++i) {
+            store.append(0, kStartMs + i * 1000, temperature(i, rng));
+            store.append(1, kStartMs + i * 1000, ramp(i));
+        }
+        return store;
+    }
+
+    template <typename Gen>
+    void report_memory(const char* name, Gen&& value) {
+        TimeSeriesStore store({name}, std::chrono::hours(6));
+        for (std::int64_t i = 0; i < kHour; ++i) store.append(0, kStartMs + i * 1000, value(i));
+
+        const auto stats = store.stats();
+        char label[96];
+        std::snprintf(label, sizeof(label), "%s, 1 h at 1 Hz (incl. allocator slack)", name);
+        std::printf("%-48s %12.1f KiB (%.1f bits/point)\n", label, static_cast<double>(stats.bytes) / 1024.0,
+                    static_cast<double>(stats.bytes) * 8.0 / static_cast<double>(stats.points));
+    }
+
+    // Same encoding as QueryServer's "range" response.
+    std::string encode_range(const std::vector<SeriesPoint>& points) {
+        nlohmann::json resp;
+        resp["metric"] = "temperature";
+        resp["points"] = nlohmann::json::array();
+        for (const auto& p : points) resp["points"].push_back({p.t_ms, p.value});
+        return resp.dump();
+    }
+
+    // Append latency on the sampling side while another thread runs full-hour range queries.
+    // On a single core the tail is dominated by preemption, not by the series lock.
+    void append_under_query_load(std::size_t appends) {
+        TimeSeriesStore store = make_store(kHour);
+        std::atomic<bool> stop {false};
+        std::thread querier([&] {
+            std::vector<SeriesPoint> points;
+            while (!stop.load(std::memory_order_relaxed)) {
+                points.clear();
+                store.range("temperature", kStartMs, kStartMs + kHour * 1000, points);
+                bench::do_not_optimize(points.data());
+            }
+        });
+
+        std::vector<double> ns(appends);
+        for (std::size_t i = 0; i < appends; ++i) {
+            const auto t0 = std::chrono::steady_clock::now();
+            store.append(0, kStartMs + (kHour + static_cast<std::int64_t>(i)) * 1000, 21.0);
+            const auto t1 = std::chrono::steady_clock::now();
+            ns[i] = std::chrono::duration<double, std::nano>(t1 - t0).count();
+        }
+        stop = true;
+        querier.join();
+
+        std::sort(ns.begin(), ns.end());
+        bench::report("append while querying (p50)", ns[ns.size() / 2], "point");
+        bench::report("append while querying (p99)", ns[ns.size() * 99 / 100], "point");
+        bench::report("append while querying (p99.9)", ns[ns.size() * 999 / 1000], "point");
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const bool quick = bench::quick_mode(argc, argv);
+    const std::size_t iters = quick ? 3 : 200;
+
+    {
+        TimeSeriesStore store({"temperature"}, std::chrono::hours(6));
+        std::int64_t t = kStartMs;
+        const double ns = bench::ns_per_op(quick ? 1000 : 1'000'000, [&] {
+            t += 1000;
+            store.append(0, t, 21.0 + static_cast<double>(t % 7) * 0.01);
+        });
+        bench::report("append", ns, "point");
+    }
+
+    std::mt19937 rng(42);
+    report_memory("temperature", [&](std::int64_t i) { return temperature(i, rng); });
+    report_memory("ramp", ramp);
+    report_memory("constant", [](std::int64_t) { return 45.0; });
+
+    const auto store = make_store(kHour);
+
+    std::vector<SeriesPoint> points;
+    const double range_ns = bench::ns_per_op(iters, [&] {
+        points.clear();
+        store.range("temperature", kStartMs, kStartMs + kHour * 1000, points);
+        bench::do_not_optimize(points.data());
+    });
+    bench::report("range, 1 h at 1 Hz (3600 points)", range_ns, "query");
+
+    const double json_ns = bench::ns_per_op(iters, [&] {
+        points.clear();
+        store.range("temperature", kStartMs, kStartMs + kHour * 1000, points);
+        bench::do_not_optimize(encode_range(points).size());
+    });
+    bench::report("range + JSON encoding (server-side cost)", json_ns, "query");
+
+    std::vector<SeriesBucket> buckets;
+    const double down_ns = bench::ns_per_op(iters, [&] {
+        buckets.clear();
+        store.downsample("temperature", kStartMs, kStartMs + kHour * 1000, 60000, buckets);
+        bench::do_not_optimize(buckets.data());
+    });
+    bench::report("downsample, 1 h into 1 min buckets", down_ns, "query");
+
+    append_under_query_load(quick ? 1000 : 200'000);
+    return 0;
+}
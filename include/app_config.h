@@ -4,8 +4,23 @@
 #include <fstream>
 #include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "latest_value_shm.h"
+
+struct WaveformConfig {
+    int sample_rate_hz = 10000;
+    int block_size = 4096; // power of two
+    std::vector<std::pair<double, double>> bands; // [lo_hz, hi_hz]
+    int snippet_len = 256; // raw samples sent on request
+
+    // simulated source until a real ADC driver exists
+    double freq_hz = 50.0;
+    double amplitude = 1.0;
+    double noise = 0.0;
+};
+
 struct MetricConfig {
     std::string name;
     std::string unit;
@@ -16,6 +31,85 @@ struct MetricConfig {
     std::string type = "simulated";
     int bus = 1; // for i2c
     std::string address = "0x76"; // for i2c
+
+    std::string file; // for replay
+    double speed = 1.0; // for replay, 0 = as fast as possible
+    bool loop = true; // for replay
+
+    WaveformConfig waveform; // for waveform
+};
+
+struct RuleConfig {
+    std::string name;
+    std::string kind = "threshold"; // threshold | rate | band
+    std::string metric;
+
+    // threshold / rate
+    std::string op = ">";
+    double value = 0.0;
+
+    // band (fires when metric is outside [low, high])
+    double low = 0.0;
+    double high = 0.0;
+    std::string with_metric; // optional second metric, must also be out of band
+    double with_low = 0.0;
+    double with_high = 0.0;
+
+    int for_ms = 0; // condition must hold this long before firing
+};
+
+struct RealtimeConfig {
+    std::vector<int> sampling_cpus; // empty = no pinning
+    std::vector<int> network_cpus;  // libmosquitto loop thread
+    std::string sched_policy = "other"; // other | fifo | rr (sampling thread)
+    int sched_priority = 0;
+
+    bool lock_memory = false;
+    int prefault_heap_kb = 0;
+    int prefault_stack_kb = 0;
+    int thread_stack_kb = 256; // every thread but the sampling loop; 0 = libc default (RLIMIT_STACK)
+};
+
+struct StoreConfig {
+    bool enabled = false;
+    int retention_hours = 6;
+    std::string socket_path = "/run/telemetry-daemon/query.sock";
+};
+
+struct IngestConfig {
+    bool enabled = false;
+    std::string socket_path = "/run/telemetry-daemon/ingest.sock";
+    unsigned socket_mode = 0600; // "socket_mode": "0660" to let the daemon's group send
+    double rate_per_s = 100.0; // per producer
+    double burst = 200.0;
+};
+
+struct RecordConfig {
+    bool enabled = false;
+    std::string directory = "recordings"; // <metric>-<utc time>-<nnn>.rec files per metric
+    int max_file_kb = 65536; // start a new file past this size
+    int max_files = 8; // per metric, oldest removed first; 0 = keep all
+};
+
+struct ShmConfig {
+    bool enabled = false;
+    std::string name = "/telemetry-latest"; // appears as /dev/shm/telemetry-latest
+};
+
+struct TlsConfig {
+    bool enabled = false;
+    std::string ca_file;
+    std::string cert_file;
+    std::string key_file;
+    std::string alpn;
+    std::string tls_version;
+    bool insecure = false;
+    bool session_resumption = true;
+};
+
+struct ReconnectConfig {
+    int min_backoff_ms = 1000;
+    int max_backoff_ms = 30000;
 };
 
 struct AppConfig {
@@ -23,6 +117,8 @@ struct AppConfig {
     std::string host = "localhost";
     int port = 1883;
     int keepalive_s = 60;
+    ReconnectConfig reconnect;
+    TlsConfig tls;
 
     std::string client_id = "pi-sim-01";
     int interval_ms = 100;
@@ -30,7 +126,16 @@ struct AppConfig {
     int qos = 1;
     bool retain = false;
 
+    int fault_disconnect_every_s = 0; // fault injection for soak runs, 0 = off
+
+    RealtimeConfig realtime;
+    StoreConfig store;
+    IngestConfig ingest;
+    RecordConfig record;
+    ShmConfig shm;
+
     std::vector<MetricConfig> metrics;
+    std::vector<RuleConfig> rules;
 };
 
 inline AppConfig load_config_or_throw(const std::string& path) {
@@ -48,11 +153,74 @@ inline AppConfig load_config_or_throw(const std::string& path) {
         cfg.host = broker.value("host", cfg.host);
         cfg.port = broker.value("port", cfg.port);
         cfg.keepalive_s = broker.value("keepalive_s", cfg.keepalive_s);
+        if (broker.contains("reconnect")) {
+            const auto& reconnect = broker.at("reconnect");
+            cfg.reconnect.min_backoff_ms = reconnect.value("min_backoff_ms", cfg.reconnect.min_backoff_ms);
+            cfg.reconnect.max_backoff_ms = reconnect.value("max_backoff_ms", cfg.reconnect.max_backoff_ms);
+        }
+        if (broker.contains("tls")) {
+            const auto& tls = broker.at("tls");
+            cfg.tls.enabled = tls.value("enabled", cfg.tls.enabled);
+            cfg.tls.ca_file = tls.value("ca_file", cfg.tls.ca_file);
+            cfg.tls.cert_file = tls.value("cert_file", cfg.tls.cert_file);
+            cfg.tls.key_file = tls.value("key_file", cfg.tls.key_file);
+            cfg.tls.alpn = tls.value("alpn", cfg.tls.alpn);
+            cfg.tls.tls_version = tls.value("tls_version", cfg.tls.tls_version);
+            cfg.tls.insecure = tls.value("insecure", cfg.tls.insecure);
+            cfg.tls.session_resumption = tls.value("session_resumption", cfg.tls.session_resumption);
+        }
     }
     cfg.client_id = jsn.value("client_id", cfg.client_id);
     cfg.interval_ms = jsn.value("interval_ms", cfg.interval_ms);
     cfg.qos = jsn.value("qos", cfg.qos);
     cfg.retain = jsn.value("retain", cfg.retain);
+    if (jsn.contains("realtime")) {
+        const auto& rt = jsn.at("realtime");
+        cfg.realtime.sampling_cpus = rt.value("sampling_cpus", cfg.realtime.sampling_cpus);
+        cfg.realtime.network_cpus = rt.value("network_cpus", cfg.realtime.network_cpus);
+        cfg.realtime.sched_policy = rt.value("sched_policy", cfg.realtime.sched_policy);
+        cfg.realtime.sched_priority = rt.value("sched_priority", cfg.realtime.sched_priority);
+        cfg.realtime.lock_memory = rt.value("lock_memory", cfg.realtime.lock_memory);
+        cfg.realtime.prefault_heap_kb = rt.value("prefault_heap_kb", cfg.realtime.prefault_heap_kb);
+        cfg.realtime.prefault_stack_kb = rt.value("prefault_stack_kb", cfg.realtime.prefault_stack_kb);
+        cfg.realtime.thread_stack_kb = rt.value("thread_stack_kb", cfg.realtime.thread_stack_kb);
+    }
+    if (jsn.contains("store")) {
+        const auto& store = jsn.at("store");
+        cfg.store.enabled = store.value("enabled", cfg.store.enabled);
+        cfg.store.retention_hours = store.value("retention_hours", cfg.store.retention_hours);
+        cfg.store.socket_path = store.value("socket_path", cfg.store.socket_path);
+    }
+    if (jsn.contains("ingest")) {
+        const auto& ingest = jsn.at("ingest");
+        cfg.ingest.enabled = ingest.value("enabled", cfg.ingest.enabled);
+        cfg.ingest.socket_path = ingest.value("socket_path", cfg.ingest.socket_path);
+        if (ingest.contains("socket_mode")) {
+            const auto mode = ingest.at("socket_mode").get<std::string>();
+            if (mode.empty() || mode.size() > 4 || mode.find_first_not_of("01234567") != std::string::npos) {
+                throw std::runtime_error("ingest.socket_mode must be an octal string like \"0660\"");
+            }
+            cfg.ingest.socket_mode = static_cast<unsigned>(std::stoul(mode, nullptr, 8));
+        }
+        cfg.ingest.rate_per_s = ingest.value("rate_per_s", cfg.ingest.rate_per_s);
+        cfg.ingest.burst = ingest.value("burst", cfg.ingest.burst);
+    }
+    if (jsn.contains("record")) {
+        const auto& record = jsn.at("record");
+        cfg.record.enabled = record.value("enabled", cfg.record.enabled);
+        cfg.record.directory = record.value("directory", cfg.record.directory);
+        cfg.record.max_file_kb = record.value("max_file_kb", cfg.record.max_file_kb);
+        cfg.record.max_files = record.value("max_files", cfg.record.max_files);
+    }
+    if (jsn.contains("shm")) {
+        const auto& shm = jsn.at("shm");
+        cfg.shm.enabled = shm.value("enabled", cfg.shm.enabled);
+        cfg.shm.name = shm.value("name", cfg.shm.name);
+    }
+    if (jsn.contains("faults")) {
+        const auto& faults = jsn.at("faults");
+        cfg.fault_disconnect_every_s = faults.value("disconnect_every_s", cfg.fault_disconnect_every_s);
+    }
     
     if (!jsn.contains("metrics") || !jsn.at("metrics").is_array() || jsn.at("metrics").empty()) {
         throw std::runtime_error("Config must contain non-empty metrics array");
@@ -63,6 +231,42 @@ inline AppConfig load_config_or_throw(const std::string& path) {
     if (cfg.client_id.empty()) throw std::runtime_error("client_id must not be empty");
     if (cfg.interval_ms <= 0) throw std::runtime_error("interval_ms must be > 0");
     if (cfg.qos < 0 || cfg.qos > 2) throw std::runtime_error("qos must be 0, 1, or 2");
+    if (cfg.reconnect.min_backoff_ms <= 0) throw std::runtime_error("broker.reconnect.min_backoff_ms must be > 0");
+    if (cfg.reconnect.max_backoff_ms < cfg.reconnect.min_backoff_ms) throw std::runtime_error("broker.reconnect.max_backoff_ms must be >= min_backoff_ms");
+    {
+        const auto& rt = cfg.realtime;
+        if (rt.sched_policy != "other" && rt.sched_policy != "fifo" && rt.sched_policy != "rr") {
+            throw std::runtime_error("realtime.sched_policy must be other, fifo, or rr");
+        }
+        if (rt.sched_policy != "other" && (rt.sched_priority < 1 || rt.sched_priority > 99)) {
+            throw std::runtime_error("realtime.sched_priority must be 1..99 for fifo/rr");
+        }
+        if (rt.prefault_heap_kb < 0 || rt.prefault_stack_kb < 0) throw std::runtime_error("realtime prefault sizes must be >= 0");
+        if (rt.thread_stack_kb != 0 && rt.thread_stack_kb < 64) throw std::runtime_error("realtime.thread_stack_kb must be 0 or >= 64");
+    }
+    if (cfg.store.enabled) {
+        if (cfg.store.retention_hours <= 0) throw std::runtime_error("store.retention_hours must be > 0");
+        if (cfg.store.socket_path.empty()) throw std::runtime_error("store.socket_path must not be empty");
+    }
+    if (cfg.ingest.enabled) {
+        if (cfg.ingest.socket_path.empty()) throw std::runtime_error("ingest.socket_path must not be empty");
+        if (cfg.ingest.rate_per_s <= 0.0) throw std::runtime_error("ingest.rate_per_s must be > 0");
+        if (cfg.ingest.burst < 1.0) throw std::runtime_error("ingest.burst must be >= 1");
+        if (cfg.ingest.socket_mode > 0777) throw std::runtime_error("ingest.socket_mode must be <= 0777");
+    }
+    if (cfg.record.enabled) {
+        if (cfg.record.directory.empty()) throw std::runtime_error("record.directory must not be empty");
+        if (cfg.record.max_file_kb <= 0) throw std::runtime_error("record.max_file_kb must be > 0");
+        if (cfg.record.max_files < 0) throw std::runtime_error("record.max_files must be >= 0");
+    }
+    if (cfg.shm.enabled && (cfg.shm.name.size() < 2 || cfg.shm.name[0] != '/' || cfg.shm.name.find('/', 1) != std::string::npos)) {
+        throw std::runtime_error("shm.name must look like /name");
+    }
+    if (cfg.tls.enabled) {
+        if (cfg.tls.ca_file.empty()) throw std::runtime_error("broker.tls.ca_file must not be empty");
+        if (cfg.tls.cert_file.empty() != cfg.tls.key_file.empty()) throw std::runtime_error("broker.tls cert_file and key_file must be set together");
+    }
+    if (cfg.fault_disconnect_every_s < 0) throw std::runtime_error("faults.disconnect_every_s must be >= 0");
 
     for (const auto& metric : jsn.at("metrics")) {
         MetricConfig metric_cfg;
@@ -76,14 +280,100 @@ inline AppConfig load_config_or_throw(const std::string& path) {
         metric_cfg.type = metric.value("type", "simulated");
         metric_cfg.bus = metric.value("bus", 1);
         metric_cfg.address = metric.value("address", "0x76");
+        metric_cfg.file = metric.value("file", "");
+        metric_cfg.speed = metric.value("speed", 1.0);
+        metric_cfg.loop = metric.value("loop", true);
+
+        if (metric.contains("waveform")) {
+            const auto& wave = metric.at("waveform");
+            auto& wave_cfg = metric_cfg.waveform;
+            wave_cfg.sample_rate_hz = wave.value("sample_rate_hz", wave_cfg.sample_rate_hz);
+            wave_cfg.block_size = wave.value("block_size", wave_cfg.block_size);
+            wave_cfg.bands = wave.value("bands", wave_cfg.bands);
+            wave_cfg.snippet_len = wave.value("snippet_len", wave_cfg.snippet_len);
+            wave_cfg.freq_hz = wave.value("freq_hz", wave_cfg.freq_hz);
+            wave_cfg.amplitude = wave.value("amplitude", wave_cfg.amplitude);
+            wave_cfg.noise = wave.value("noise", wave_cfg.noise);
+        }
 
         // validate metric
         if (metric_cfg.name.empty()) throw std::runtime_error("metric name must not be empty");
         if (metric_cfg.topic_suffix.empty()) throw std::runtime_error("topic_suffix must not be empty");
+        // shm entries hold NUL-terminated fixed-size names; a truncated name would be unfindable or ambiguous
+        if (cfg.shm.enabled && metric_cfg.name.size() >= latest_value_shm::kNameLen) {
+            throw std::runtime_error("metric name '" + metric_cfg.name + "' is longer than " + std::to_string(latest_value_shm::kNameLen - 1) + " bytes (shm.enabled)");
+        }
+        if (cfg.shm.enabled && metric_cfg.unit.size() >= latest_value_shm::kUnitLen) {
+            throw std::runtime_error("metric unit '" + metric_cfg.unit + "' is longer than " + std::to_string(latest_value_shm::kUnitLen - 1) + " bytes (shm.enabled)");
+        }
+        if (metric_cfg.type == "replay" && metric_cfg.file.empty()) throw std::runtime_error("replay metric '" + metric_cfg.name + "' needs a file");
+        if (metric_cfg.speed < 0.0) throw std::runtime_error("speed must be >= 0");
+        if (metric_cfg.type == "waveform") {
+            const auto& wave_cfg = metric_cfg.waveform;
+            const auto block = static_cast<unsigned>(wave_cfg.block_size);
+            if (wave_cfg.sample_rate_hz <= 0) throw std::runtime_error("waveform.sample_rate_hz must be > 0");
+            if (wave_cfg.block_size < 16 || (block & (block - 1)) != 0) throw std::runtime_error("waveform.block_size must be a power of two >= 16");
+            if (wave_cfg.snippet_len < 0) throw std::runtime_error("waveform.snippet_len must be >= 0");
+            for (const auto& [lo, hi] : wave_cfg.bands) {
+                if (lo < 0.0 || lo > hi) throw std::runtime_error("waveform band must satisfy 0 <= lo <= hi");
+            }
+        }
 
         cfg.metrics.push_back(std::move(metric_cfg));
     }
 
+    const auto has_metric = [&cfg](const std::string& name) {
+        for (const auto& m : cfg.metrics) if (m.name == name) return true;
+        return false;
+    };
+    // waveform channels publish block features, never a scalar reading the rules could see
+    const auto is_waveform = [&cfg](const std::string& name) {
+        for (const auto& m : cfg.metrics) if (m.name == name) return m.type == "waveform";
+        return false;
+    };
+
+    if (jsn.contains("rules")) {
+        for (const auto& rule : jsn.at("rules")) {
+            RuleConfig rule_cfg;
+
+            rule_cfg.name = rule.at("name").get<std::string>();
+            rule_cfg.kind = rule.value("kind", rule_cfg.kind);
+            rule_cfg.metric = rule.at("metric").get<std::string>();
+            rule_cfg.op = rule.value("op", rule_cfg.op);
+            rule_cfg.value = rule.value("value", 0.0);
+            rule_cfg.low = rule.value("low", 0.0);
+            rule_cfg.high = rule.value("high", 0.0);
+            rule_cfg.for_ms = rule.value("for_ms", 0);
+
+            if (rule.contains("with")) {
+                const auto& with = rule.at("with");
+                rule_cfg.with_metric = with.at("metric").get<std::string>();
+                rule_cfg.with_low = with.value("low", 0.0);
+                rule_cfg.with_high = with.value("high", 0.0);
+            }
+
+            // validate rule
+            if (rule_cfg.name.empty()) throw std::runtime_error("rule name must not be empty");
+            if (!has_metric(rule_cfg.metric)) throw std::runtime_error("rule '" + rule_cfg.name + "' references unknown metric: " + rule_cfg.metric);
+            if (is_waveform(rule_cfg.metric)) throw std::runtime_error("rule '" + rule_cfg.name + "' references waveform metric: " + rule_cfg.metric);
+            if (rule_cfg.kind != "threshold" && rule_cfg.kind != "rate" && rule_cfg.kind != "band") {
+                throw std::runtime_error("rule kind must be threshold, rate, or band");
+            }
+            if (rule_cfg.op != ">" && rule_cfg.op != ">=" && rule_cfg.op != "<" && rule_cfg.op != "<=") {
+                throw std::runtime_error("rule op must be >, >=, <, or <=");
+            }
+            if (rule_cfg.kind == "band" && rule_cfg.low > rule_cfg.high) throw std::runtime_error("rule low must be <= high");
+            if (!rule_cfg.with_metric.empty()) {
+                if (rule_cfg.kind != "band") throw std::runtime_error("rule 'with' is only valid for band rules");
+                if (!has_metric(rule_cfg.with_metric)) throw std::runtime_error("rule '" + rule_cfg.name + "' references unknown metric: " + rule_cfg.with_metric);
+                if (is_waveform(rule_cfg.with_metric)) throw std::runtime_error("rule '" + rule_cfg.name + "' references waveform metric: " + rule_cfg.with_metric);
+                if (rule_cfg.with_low > rule_cfg.with_high) throw std::runtime_error("rule with.low must be <= with.high");
+            }
+            if (rule_cfg.for_ms < 0) throw std::runtime_error("rule for_ms must be >= 0");
+
+            cfg.rules.push_back(std::move(rule_cfg));
+        }
+    }
 
     return cfg;
 }
\ No newline at end of file
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "app_config.h"
+#include "sensor.h"
+#include "waveform_channel.h"
+
+class MqttClient;
+class RuleEngine;
+class SystemdNotifier;
+class TimeSeriesStore;
+class QueryServer;
+class IngestSocket;
+class Recorder;
+class LatestValueTable;
+
+struct SensorEntry {
+    std::string topic;
+    std::unique_ptr<ISensor> sensor;
+    std::size_t metric_idx; // position in AppConfig::metrics
+};
+
+struct WaveformEntry {
+    std::string topic;
+    std::string snippet_topic;
+    std::unique_ptr<WaveformChannel> channel;
+    WaveformFeatures features;
+};
+
+// Optional pipeline stages wired up by the caller; pointers are null when disabled.
+struct Pipeline {
+    RuleEngine& rules;
+    SystemdNotifier& notifier;
+    std::vector<WaveformEntry>& waveforms;
+    TimeSeriesStore* store = nullptr;
+    const QueryServer* query_server = nullptr;
+    IngestSocket* ingest = nullptr;
+    Recorder* recorder = nullptr;
+    LatestValueTable* latest = nullptr;
+};
+
+std::vector<SensorEntry> build_sensors(const AppConfig& cfg);
+
+// Channels are not started. Start them before the sampling thread's CPU mask and scheduling
+// policy are applied, since the producer threads inherit both.
+std::vector<WaveformEntry> build_waveforms(const AppConfig& cfg);
+
+void subscribe_snippet_requests(MqttClient& mqtt, const AppConfig& cfg, std::vector<WaveformEntry>& waveforms);
+
+// The sampling loop: runs until `running` is cleared, publishing readings, events and health.
+int run_loop(MqttClient& mqtt, const AppConfig& cfg, std::vector<SensorEntry>& sensors, Pipeline& pipeline,
+             const std::atomic<bool>& running);
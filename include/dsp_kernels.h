@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+// Vectorized block kernels for waveform feature extraction.
+// SSE2 on x86-64, NEON on AArch64/ARMv7 with NEON, scalar elsewhere (selected at compile time).
+// The NEON path has not yet been compiled or run on an ARM target.
+namespace dsp {
+
+    std::string_view isa();
+
+    double sum(const float* x, std::size_t n);
+    double sum_squares(const float* x, std::size_t n);
+    float max_abs(const float* x, std::size_t n);
+
+    // out[i] = a[i] * b[i]
+    void multiply(const float* a, const float* b, float* out, std::size_t n);
+
+    // out[i] = re[i]^2 + im[i]^2
+    void power(const float* re, const float* im, float* out, std::size_t n);
+
+    // In-place radix-2 FFT over split real/imaginary arrays. n must be a power of two.
+    // Butterflies run four at a time in every stage from the third on (half-length >= 4).
+    class Fft {
+        public:
+            explicit Fft(std::size_t n);
+
+            void forward(float* re, float* im) const;
+            std::size_t size() const noexcept { return n_; }
+
+        private:
+            std::size_t n_;
+            std::vector<std::size_t> bitrev_;
+            std::vector<float> tw_re_; // per-stage twiddles, see the constructor
+            std::vector<float> tw_im_;
+    };
+
+} // namespace dsp
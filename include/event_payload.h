@@ -0,0 +1,26 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+#include <cstdint>
+#include <string_view>
+
+#include "telemetry_payload.h"
+
+inline nlohmann::json make_event_payload_v1(
+    std::string_view client_id,
+    std::string_view rule,
+    std::string_view metric_name,
+    std::string_view state,
+    double value,
+    std::uint64_t seq
+) {
+    return {
+        {"schema_version", 1},
+        {"device", {{"client_id", client_id}}},
+        {"rule", rule},
+        {"state", state},
+        {"metric", {{"name", metric_name}, {"value", value}}},
+        {"timestamp_s", unix_time_s()},
+        {"seq", seq}
+    };
+}
@@ -0,0 +1,193 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Gorilla-style compression (Pelkonen et al., VLDB 2015):
+// delta-of-delta timestamps and XOR-encoded doubles packed into a bit stream.
+
+class BitWriter {
+    public:
+        // Appends the low `nbits` of `value`, most significant bit first. nbits in [0, 64].
+        void write(std::uint64_t value, int nbits) {
+            while (nbits > 0) {
+                const std::size_t used = bit_count_ & 63;
+                if (used == 0) words_.push_back(0);
+
+                const int room = 64 - static_cast<int>(used);
+                const int take = nbits < room ? nbits : room;
+                const std::uint64_t chunk = (take == 64 ? value : (value >> (nbits - take)) & ((std::uint64_t{1} << take) - 1));
+
+                words_.back() |= chunk << (room - take);
+                bit_count_ += static_cast<std::size_t>(take);
+                nbits -= take;
+            }
+        }
+
+        void write_bit(bool bit) { write(bit ? 1u : 0u, 1); }
+
+        std::size_t bit_count() const noexcept { return bit_count_; }
+        std::size_t bytes() const noexcept { return words_.capacity() * sizeof(std::uint64_t); }
+        const std::vector<std::uint64_t>& words() const noexcept { return words_; }
+
+    private:
+        std::vector<std::uint64_t> words_;
+        std::size_t bit_count_ = 0;
+};
+
+class BitReader {
+    public:
+        BitReader(const std::vector<std::uint64_t>& words, std::size_t bit_count)
+            : words_(words), bit_count_(bit_count) {}
+
+        std::uint64_t read(int nbits) {
+            std::uint64_t out = 0;
+            while (nbits > 0) {
+                const std::size_t used = pos_ & 63;
+                const int room = 64 - static_cast<int>(used);
+                const int take = nbits < room ? nbits : room;
+                const std::uint64_t word = words_[pos_ >> 6];
+                const std::uint64_t chunk = take == 64 ? word : (word >> (room - take)) & ((std::uint64_t{1} << take) - 1);
+
+                out = take == 64 ? chunk : (out << take) | chunk;
+                pos_ += static_cast<std::size_t>(take);
+                nbits -= take;
+            }
+            return out;
+        }
+
+        bool read_bit() { return read(1) != 0; }
+        bool done() const noexcept { return pos_ >= bit_count_; }
+
+    private:
+        const std::vector<std::uint64_t>& words_;
+        std::size_t bit_count_;
+        std::size_t pos_ = 0;
+};
+
+// One append-only compressed block of (timestamp_ms, value) points.
+class GorillaChunk {
+    public:
+        explicit GorillaChunk(std::int64_t start_ms) : start_ms_(start_ms) {}
+
+        void append(std::int64_t t_ms, double value) {
+            const auto bits = std::bit_cast<std::uint64_t>(value);
+
+            if (count_ == 0) {
+                out_.write(static_cast<std::uint64_t>(t_ms), 64);
+                out_.write(bits, 64);
+            } else {
+                write_timestamp_(t_ms - prev_ts_ - prev_delta_);
+                prev_delta_ = t_ms - prev_ts_;
+                write_value_(bits ^ prev_bits_);
+            }
+
+            prev_ts_ = t_ms;
+            prev_bits_ = bits;
+            ++count_;
+        }
+
+        // Decodes every point in order: f(t_ms, value).
+        template <class F>
+        void for_each(F&& f) const {
+            if (count_ == 0) return;
+
+            BitReader in(out_.words(), out_.bit_count());
+            std::int64_t ts = static_cast<std::int64_t>(in.read(64));
+            std::uint64_t bits = in.read(64);
+            std::int64_t delta = 0;
+            int leading = 0;
+            int trailing = 0;
+
+            f(ts, std::bit_cast<double>(bits));
+
+            for (std::size_t i = 1; i < count_; ++i) {
+                delta += read_timestamp_(in);
+                ts += delta;
+
+                if (in.read_bit()) {
+                    if (in.read_bit()) {
+                        leading = static_cast<int>(in.read(5));
+                        const int len = static_cast<int>(in.read(6)) + 1;
+                        trailing = 64 - leading - len;
+                    }
+                    const int len = 64 - leading - trailing;
+                    bits ^= in.read(len) << trailing;
+                }
+
+                f(ts, std::bit_cast<double>(bits));
+            }
+        }
+
+        std::int64_t start_ms() const noexcept { return start_ms_; }
+        std::int64_t last_ms() const noexcept { return prev_ts_; }
+        std::size_t count() const noexcept { return count_; }
+        std::size_t bytes() const noexcept { return out_.bytes(); }
+
+    private:
+        std::int64_t start_ms_;
+        BitWriter out_;
+        std::size_t count_ = 0;
+
+        std::int64_t prev_ts_ = 0;
+        std::int64_t prev_delta_ = 0;
+        std::uint64_t prev_bits_ = 0;
+        int prev_leading_ = -1;
+        int prev_trailing_ = 0;
+
+        void write_timestamp_(std::int64_t dod) {
+            if (dod == 0) {
+                out_.write(0b0, 1);
+            } else if (dod >= -63 && dod <= 64) {
+                out_.write(0b10, 2);
+                out_.write(static_cast<std::uint64_t>(dod + 63), 7);
+            } else if (dod >= -255 && dod <= 256) {
+                out_.write(0b110, 3);
+                out_.write(static_cast<std::uint64_t>(dod + 255), 9);
+            } else if (dod >= -2047 && dod <= 2048) {
+                out_.write(0b1110, 4);
+                out_.write(static_cast<std::uint64_t>(dod + 2047), 12);
+            } else {
+                out_.write(0b1111, 4);
+                out_.write(static_cast<std::uint64_t>(dod), 64);
+            }
+        }
+
+        static std::int64_t read_timestamp_(BitReader& in) {
+            if (!in.read_bit()) return 0;
+            if (!in.read_bit()) return static_cast<std::int64_t>(in.read(7)) - 63;
+            if (!in.read_bit()) return static_cast<std::int64_t>(in.read(9)) - 255;
+            if (!in.read_bit()) return static_cast<std::int64_t>(in.read(12)) - 2047;
+            return static_cast<std::int64_t>(in.read(64));
+        }
+
+        void write_value_(std::uint64_t xored) {
+            if (xored == 0) {
+                out_.write_bit(false);
+                return;
+            }
+            out_.write_bit(true);
+
+            int leading = std::countl_zero(xored);
+            const int trailing = std::countr_zero(xored);
+            if (leading > 31) leading = 31; // 5-bit field
+
+            if (prev_leading_ >= 0 && leading >= prev_leading_ && trailing >= prev_trailing_) {
+                // fits in the previous meaningful-bit window
+                out_.write_bit(false);
+                out_.write(xored >> prev_trailing_, 64 - prev_leading_ - prev_trailing_);
+                return;
+            }
+
+            const int len = 64 - leading - trailing;
+            out_.write_bit(true);
+            out_.write(static_cast<std::uint64_t>(leading), 5);
+            out_.write(static_cast<std::uint64_t>(len - 1), 6);
+            out_.write(xored >> trailing, len);
+
+            prev_leading_ = leading;
+            prev_trailing_ = trailing;
+        }
+};
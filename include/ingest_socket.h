@@ -0,0 +1,75 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <sys/types.h>
+#include <vector>
+
+#include "sensor.h"
+
+// Unix datagram endpoint for local producers. Each datagram carries one or more
+// newline-separated readings: "<metric> <value> [unit]".
+// Drained non-blocking from the sampling loop with recvmmsg(); producers are identified by
+// SCM_CREDENTIALS pid and rate limited with a token bucket each.
+class IngestSocket {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        struct ProducerStats {
+            pid_t pid = 0;
+            std::uint64_t accepted = 0;
+            std::uint64_t invalid = 0;
+            std::uint64_t rate_limited = 0;
+        };
+
+        // `reserved_names` are topic levels already owned by configured metrics (their topic_suffix).
+        IngestSocket(std::string socket_path, double rate_per_s, double burst,
+                     mode_t socket_mode = 0600, std::vector<std::string> reserved_names = {});
+        ~IngestSocket();
+
+        IngestSocket(const IngestSocket&) = delete;
+        IngestSocket& operator = (const IngestSocket&) = delete;
+
+        bool start();
+
+        // Appends validated readings to `out`, reading at most max_datagrams per call.
+        std::size_t drain(std::vector<Reading>& out, Clock::time_point now, std::size_t max_datagrams = 256);
+
+        std::uint64_t datagrams() const noexcept { return datagrams_; }
+        std::uint64_t accepted() const noexcept { return accepted_; }
+        std::uint64_t invalid() const noexcept { return invalid_; }
+        std::uint64_t rate_limited() const noexcept { return rate_limited_; }
+        std::vector<ProducerStats> producers() const;
+
+    private:
+        struct Producer {
+            ProducerStats stats;
+            double tokens = 0.0;
+            Clock::time_point last_seen {};
+        };
+
+        static constexpr std::size_t kBatch = 32;
+        static constexpr std::size_t kMaxDatagram = 1024;
+        static constexpr std::size_t kMaxProducers = 64;
+
+        std::string socket_path_;
+        int fd_ = -1;
+        double rate_per_s_;
+        double burst_;
+        mode_t socket_mode_;
+        std::vector<std::string> reserved_names_;
+
+        std::vector<Producer> producers_;
+
+        std::uint64_t datagrams_ = 0;
+        std::uint64_t accepted_ = 0;
+        std::uint64_t invalid_ = 0;
+        std::uint64_t rate_limited_ = 0;
+
+        Producer& producer_(pid_t pid, Clock::time_point now);
+        bool valid_name_(std::string_view name) const;
+        void parse_datagram_(const char* data, std::size_t len, pid_t pid, Clock::time_point now, std::vector<Reading>& out);
+};
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// Fixed-size log2 histogram of durations in microseconds. Constant memory, no allocation.
+// Bucket i holds samples in [2^(i-1), 2^i) us; bucket 0 holds sub-microsecond samples.
+class LatencyHistogram {
+    public:
+        static constexpr std::size_t kBuckets = 32;
+
+        void record(std::chrono::nanoseconds d) noexcept {
+            const auto us = d.count() <= 0 ? 0u : static_cast<std::uint64_t>(d.count()) / 1000u;
+            const std::size_t idx = us == 0 ? 0 : std::min<std::size_t>(std::bit_width(us), kBuckets - 1);
+            ++buckets_[idx];
+            ++count_;
+            if (us > max_us_) max_us_ = us;
+        }
+
+        // Upper bound (us) of the bucket containing the p-th percentile, p in [0, 100].
+        std::uint64_t percentile_us(double p) const noexcept {
+            if (count_ == 0) return 0;
+            const auto target = static_cast<std::uint64_t>(static_cast<double>(count_) * p / 100.0);
+            std::uint64_t seen = 0;
+            for (std::size_t i = 0; i < kBuckets; ++i) {
+                seen += buckets_[i];
+                if (seen > target || seen == count_) return std::min<std::uint64_t>(std::uint64_t{1} << i, max_us_);
+            }
+            return max_us_;
+        }
+
+        std::uint64_t count() const noexcept { return count_; }
+        std::uint64_t max_us() const noexcept { return max_us_; }
+        const std::array<std::uint64_t, kBuckets>& buckets() const noexcept { return buckets_; }
+
+        void reset() noexcept { *this = LatencyHistogram{}; }
+
+    private:
+        std::array<std::uint64_t, kBuckets> buckets_ {};
+        std::uint64_t count_ = 0;
+        std::uint64_t max_us_ = 0;
+};
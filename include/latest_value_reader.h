@@ -0,0 +1,160 @@
+#pragma once
+
+// Header-only reader for the daemon's shared-memory latest-value table.
+// Link nothing but this header; reads are a handful of loads, no syscalls.
+//
+//   LatestValueReader reader;
+//   if (reader.open("/telemetry-latest")) {
+//       const int idx = reader.find("temperature");
+//       LatestValue v;
+//       if (idx >= 0 && reader.read(idx, v)) { ... }
+//   }
+//
+// A restarted daemon publishes a new table under the same name and the old mapping stops
+// updating. Call stale() now and then (it makes syscalls) and open() again when it returns true.
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "latest_value_shm.h"
+
+struct LatestValue {
+    double value;
+    std::int64_t timestamp_ms;
+    std::uint64_t seq;
+};
+
+class LatestValueReader {
+    public:
+        LatestValueReader() = default;
+        ~LatestValueReader() { close(); }
+
+        LatestValueReader(const LatestValueReader&) = delete;
+        LatestValueReader& operator = (const LatestValueReader&) = delete;
+
+        bool open(const char* shm_name) {
+            close();
+
+            const int fd = ::shm_open(shm_name, O_RDONLY | O_CLOEXEC, 0);
+            if (fd < 0) return false;
+
+            struct stat st {};
+            if (::fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < latest_value_shm::entries_offset()) {
+                ::close(fd);
+                return false;
+            }
+
+            len_ = static_cast<std::size_t>(st.st_size);
+            map_ = ::mmap(nullptr, len_, PROT_READ, MAP_SHARED, fd, 0);
+            ::close(fd);
+            if (map_ == MAP_FAILED) {
+                map_ = nullptr;
+                return false;
+            }
+
+            // the acquire pairs with the writer's release store and makes the rest of the header visible
+            const auto* header = static_cast<const latest_value_shm::Header*>(map_);
+            const std::uint64_t generation = header->generation.load(std::memory_order_acquire);
+            if (generation == 0 ||
+                std::memcmp(header->magic, latest_value_shm::kMagic, sizeof(header->magic)) != 0 ||
+                header->version != latest_value_shm::kVersion ||
+                header->entry_size != sizeof(latest_value_shm::Entry) ||
+                latest_value_shm::table_size(header->entry_count) > len_) {
+                close();
+                return false;
+            }
+
+            count_ = header->entry_count;
+            entries_ = reinterpret_cast<const latest_value_shm::Entry*>(static_cast<const char*>(map_) + latest_value_shm::entries_offset());
+            generation_ = generation;
+            shm_name_ = shm_name;
+            return true;
+        }
+
+        void close() noexcept {
+            if (map_) ::munmap(map_, len_);
+            map_ = nullptr;
+            entries_ = nullptr;
+            count_ = 0;
+            generation_ = 0;
+        }
+
+        // True once the daemon that published this mapping has shut down, or `shm_name` now holds
+        // a table from a newer start (e.g. after a crash and restart). One shm_open and one pread.
+        bool stale() const noexcept {
+            if (!map_) return true;
+            const auto* header = static_cast<const latest_value_shm::Header*>(map_);
+            if (header->generation.load(std::memory_order_acquire) != generation_) return true;
+
+            const int fd = ::shm_open(shm_name_.c_str(), O_RDONLY | O_CLOEXEC, 0);
+            if (fd < 0) return true;
+            std::uint64_t current = 0;
+            const ssize_t n = ::pread(fd, &current, sizeof(current), offsetof(latest_value_shm::Header, generation));
+            ::close(fd);
+            return n != static_cast<ssize_t>(sizeof(current)) || current != generation_;
+        }
+
+        // The writer's start identifier this mapping was opened with, 0 if not open.
+        std::uint64_t generation() const noexcept { return generation_; }
+
+        std::size_t size() const noexcept { return count_; }
+
+        std::string_view name(std::size_t idx) const noexcept {
+            if (idx >= count_) return {};
+            return std::string_view(entries_[idx].name, ::strnlen(entries_[idx].name, latest_value_shm::kNameLen));
+        }
+
+        std::string_view unit(std::size_t idx) const noexcept {
+            if (idx >= count_) return {};
+            return std::string_view(entries_[idx].unit, ::strnlen(entries_[idx].unit, latest_value_shm::kUnitLen));
+        }
+
+        // Index of `metric`, or -1. Resolve once and keep the index.
+        int find(std::string_view metric) const noexcept {
+            for (std::size_t i = 0; i < count_; ++i) {
+                if (name(i) == metric) return static_cast<int>(i);
+            }
+            return -1;
+        }
+
+        // Consistent snapshot of one entry. Returns false if the entry was never written
+        // or a writer kept it busy for max_spins attempts.
+        bool read(std::size_t idx, LatestValue& out, int max_spins = 1000) const noexcept {
+            if (idx >= count_) return false;
+            const auto& e = entries_[idx];
+
+            for (int spin = 0; spin < max_spins; ++spin) {
+                const std::uint64_t before = e.lock.load(std::memory_order_acquire);
+                if (before & 1u) continue;
+
+                const std::uint64_t bits = e.value_bits.load(std::memory_order_relaxed);
+                const std::int64_t ts = e.timestamp_ms.load(std::memory_order_relaxed);
+                const std::uint64_t seq = e.seq.load(std::memory_order_relaxed);
+
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (e.lock.load(std::memory_order_relaxed) != before) continue;
+                if (before == 0) return false; // never written
+
+                out = LatestValue{std::bit_cast<double>(bits), ts, seq};
+                return true;
+            }
+            return false;
+        }
+
+    private:
+        void* map_ = nullptr;
+        std::size_t len_ = 0;
+        const latest_value_shm::Entry* entries_ = nullptr;
+        std::size_t count_ = 0;
+        std::uint64_t generation_ = 0;
+        std::string shm_name_;
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+// Layout of the POSIX shared-memory latest-value table, shared by the daemon (writer)
+// and LatestValueReader. Each entry is guarded by its own seqlock; readers never block the writer.
+namespace latest_value_shm {
+
+    inline constexpr char kMagic[8] = {'T', 'L', 'M', 'L', 'A', 'T', 'S', '1'};
+    inline constexpr std::uint32_t kVersion = 2;
+    inline constexpr std::size_t kNameLen = 48;
+    inline constexpr std::size_t kUnitLen = 16;
+
+    struct Header {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t entry_count;
+        std::uint32_t entry_size;
+        std::uint32_t reserved;
+        // Stored last (release) once everything above and the entries are initialised. Unique per
+        // daemon start (CLOCK_REALTIME ns), and set back to 0 when that daemon shuts down, so a
+        // reader can tell its mapping from the one a restarted daemon published under the same name.
+        std::atomic<std::uint64_t> generation;
+    };
+
+    struct alignas(64) Entry {
+        std::atomic<std::uint64_t> lock;        // seqlock: odd while a write is in progress
+        std::atomic<std::uint64_t> value_bits;  // double, bit-cast
+        std::atomic<std::int64_t> timestamp_ms;
+        std::atomic<std::uint64_t> seq;
+        char name[kNameLen];                     // immutable after creation
+        char unit[kUnitLen];
+    };
+
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "seqlock needs lock-free 64-bit atomics");
+    static_assert(sizeof(Header) % 8 == 0);
+    static_assert(std::is_standard_layout_v<Header>, "readers pread() the generation at its offset");
+
+    inline constexpr std::size_t entries_offset() { return (sizeof(Header) + alignof(Entry) - 1) / alignof(Entry) * alignof(Entry); }
+    inline constexpr std::size_t table_size(std::size_t entries) { return entries_offset() + entries * sizeof(Entry); }
+
+} // namespace latest_value_shm
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "latest_value_shm.h"
+
+struct MetricConfig;
+
+// Writer side of the shared-memory latest-value table (see latest_value_reader.h).
+// Single writer: only the sampling loop calls update().
+class LatestValueTable {
+    public:
+        LatestValueTable(std::string shm_name, const std::vector<MetricConfig>& metrics);
+        ~LatestValueTable();
+
+        LatestValueTable(const LatestValueTable&) = delete;
+        LatestValueTable& operator = (const LatestValueTable&) = delete;
+
+        bool open();
+        void update(std::size_t metric_idx, double value, std::int64_t timestamp_ms, std::uint64_t seq) noexcept;
+
+    private:
+        std::string shm_name_;
+        std::vector<std::pair<std::string, std::string>> names_; // name, unit
+        void* map_ = nullptr;
+        std::size_t len_ = 0;
+        latest_value_shm::Entry* entries_ = nullptr;
+};
@@ -3,9 +3,38 @@
 #include <mosquitto.h>
 #include <atomic>
 #include <chrono>
+#include <functional>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <string_view>
+#include <vector>
+
+class TlsSessionCache;
+
+struct MqttTlsOptions {
+    std::string ca_file;
+    std::string cert_file; // optional client certificate
+    std::string key_file;
+    std::string alpn;      // optional, e.g. "mqtt"
+    std::string tls_version; // empty = library default
+    bool insecure = false; // skip hostname verification (testing only)
+    bool session_resumption = true;
+};
+
+struct MqttReconnectOptions {
+    std::chrono::milliseconds min_backoff {1000};  // delay after the first attempt
+    std::chrono::milliseconds max_backoff {30000}; // doubling stops here
+};
+
+struct TlsStats {
+    bool enabled = false;
+    bool resumption = false; // false when built without OpenSSL
+    std::uint64_t handshakes = 0;
+    std::uint64_t resumed = 0;
+    std::uint64_t last_handshake_us = 0;
+    std::uint64_t total_handshake_us = 0;
+};
 
 class MqttClient {
     public:
@@ -14,13 +43,29 @@ class MqttClient {
 
         MqttClient(const MqttClient&) = delete;
         MqttClient& operator = (const MqttClient&) = delete;
+
+        bool configure_tls(const MqttTlsOptions& opts); // call before connect()
+        void set_reconnect_options(const MqttReconnectOptions& opts); // call before connect()
+        TlsStats tls_stats() const;
+        // time from (re)connect request to CONNACK, including TCP and TLS
+        std::uint64_t last_connect_us() const noexcept { return last_connect_us_.load(std::memory_order_relaxed); }
         
         bool connect(int keepalive_seconds = 60);
         void tick(); // pulse (non-blocking reconnect attempts)
         std::uint64_t reconnects() const noexcept { return reconnects_.load(std::memory_order_relaxed); }
+        std::int64_t backoff_ms() const noexcept { return backoff_ms_.load(std::memory_order_relaxed); }
+        bool connected() const noexcept { return connected_.load(std::memory_order_acquire); }
+        
+        void drop_connection(); // fault injection: sever the socket as a network failure would
         
         bool publish(std::string_view topic, std::string_view payload, int qos = 0, bool retain = false);
 
+        // Register before connect(); subscriptions are (re)issued on every successful connect.
+        // Topics are matched exactly (no wildcards).
+        // The handler runs on the mosquitto network thread and must not block.
+        using MessageHandler = std::function<void(std::string_view topic, std::string_view payload)>;
+        void subscribe(std::string topic, MessageHandler handler);
+
         void stop() noexcept;
 
         const std::string& client_id() const { return client_id_; }
@@ -40,12 +85,13 @@ class MqttClient {
 
         static void on_connect(struct mosquitto* mosq, void* obj, int rc);
         static void on_disconnect(struct mosquitto* mosq, void* obj, int rc);
+        static void on_message(struct mosquitto* mosq, void* obj, const struct mosquitto_message* msg);
         bool ensure_connected();
 
         // reconnect
         std::chrono::steady_clock::time_point next_reconnect_ {};
-        int backoff_seconds_ = 1;
-        static constexpr int kMaxBackoffSeconds = 30;
+        MqttReconnectOptions reconnect_opts_;
+        std::atomic<std::int64_t> backoff_ms_ {1000};
         std::atomic<uint64_t> reconnects_{0};
 
         void tick_reconnect_();
@@ -58,4 +104,21 @@ class MqttClient {
 
         void setup_lwt_();
         void publish_status_(const std::string& payload);
+
+        // subscriptions
+        struct Subscription {
+            std::string topic;
+            MessageHandler handler;
+        };
+        std::vector<Subscription> subscriptions_;
+
+        void subscribe_all_();
+
+        // TLS / reconnect cost
+        bool tls_enabled_ = false;
+        std::unique_ptr<TlsSessionCache> tls_sessions_;
+        std::atomic<std::int64_t> connect_started_ns_ {0};
+        std::atomic<std::uint64_t> last_connect_us_ {0};
+
+        void mark_connect_started_();
 };
\ No newline at end of file
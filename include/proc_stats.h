@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <unistd.h>
+
+// Resident set size of this process in KiB, or 0 if /proc is unavailable.
+inline std::uint64_t read_rss_kb() {
+    std::ifstream statm("/proc/self/statm");
+    std::uint64_t size_pages = 0;
+    std::uint64_t resident_pages = 0;
+    if (!(statm >> size_pages >> resident_pages)) return 0;
+
+    const long page_size = sysconf(_SC_PAGESIZE);
+    return resident_pages * static_cast<std::uint64_t>(page_size > 0 ? page_size : 4096) / 1024;
+}
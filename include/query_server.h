@@ -0,0 +1,64 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+class TimeSeriesStore;
+
+// Serves line-delimited JSON queries against a TimeSeriesStore on a unix stream socket.
+//   {"op":"metrics"}
+//   {"op":"latest","metric":"temperature"}
+//   {"op":"range","metric":"temperature","from_ms":...,"to_ms":...}
+//   {"op":"downsample","metric":"temperature","from_ms":...,"to_ms":...,"step_ms":60000}
+// One thread serves up to kMaxClients connections with poll(); a connection that has not completed
+// a request within kRequestTimeout is closed, however slowly it keeps sending. While a response is
+// being sent the timeout restarts with every send that makes progress, so a large response to a
+// slow reader is not cut off, but a client that stops reading is.
+class QueryServer {
+    public:
+        QueryServer(const TimeSeriesStore& store, std::string socket_path);
+        ~QueryServer();
+
+        QueryServer(const QueryServer&) = delete;
+        QueryServer& operator = (const QueryServer&) = delete;
+
+        bool start();
+        void stop() noexcept;
+
+        std::uint64_t queries() const noexcept { return queries_.load(std::memory_order_relaxed); }
+        std::uint64_t query_ns_total() const noexcept { return query_ns_.load(std::memory_order_relaxed); }
+
+        static constexpr std::size_t kMaxClients = 16;
+        static constexpr std::chrono::seconds kRequestTimeout {5};
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        struct Client {
+            int fd = -1;
+            std::string in;
+            std::string out;
+            Clock::time_point deadline;
+            bool eof = false;
+        };
+
+        const TimeSeriesStore& store_;
+        std::string socket_path_;
+        int listen_fd_ = -1;
+        std::thread thread_;
+        std::atomic<bool> stopping_ {false};
+
+        std::atomic<std::uint64_t> queries_ {0};
+        std::atomic<std::uint64_t> query_ns_ {0};
+
+        void serve_();
+        void accept_(std::vector<Client>& clients);
+        // Return false when the connection should be closed.
+        bool read_(Client& client);
+        bool flush_(Client& client);
+        std::string handle_request_(const std::string& line);
+};
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Helpers for jitter-sensitive deployments. All functions act on the calling thread
+// (or the whole process for memory locking) and return false with a warning logged on failure.
+
+// Restrict the calling thread to `cpus`. Threads created afterwards inherit the mask.
+bool set_thread_affinity(const std::vector<int>& cpus);
+
+// The calling thread's current mask, e.g. to restore it after a temporary set_thread_affinity().
+// Empty on failure, which set_thread_affinity() treats as a no-op.
+std::vector<int> get_thread_affinity();
+
+// policy: "other" | "fifo" | "rr". priority is ignored for "other".
+bool set_thread_scheduling(const std::string& policy, int priority);
+
+// Stack size for threads created afterwards without an explicit one (std::thread, libmosquitto's
+// loop thread). The glibc default follows RLIMIT_STACK, usually 8 MiB, and under mlockall all of
+// it is resident, so every helper thread would cost that much RAM.
+bool set_default_thread_stack(std::size_t kb);
+
+// mlockall(MCL_CURRENT | MCL_FUTURE), then touch heap_kb of heap and stack_kb of stack
+// so the sampling loop does not take page faults later.
+bool lock_and_prefault_memory(std::size_t heap_kb, std::size_t stack_kb);
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "replay_format.h"
+
+struct MetricConfig;
+struct RecordConfig;
+
+// Captures live readings into replay files, one series of files per scalar metric:
+// <directory>/<metric>-<UTC yyyymmddThhmmssZ>-<nnn>.rec. Characters outside [A-Za-z0-9_.-] in the
+// metric name become '_' in the file name, and waveform metrics are skipped since they never
+// produce scalar readings.
+// Every file is created new (O_EXCL), so a restart never truncates an earlier recording or a file
+// a ReplaySensor has mapped. A file is closed and a new one started once it reaches max_file_kb;
+// beyond max_files per metric the oldest are unlinked, which leaves existing mappings intact.
+// append() only queues the record; a writer thread does the file I/O.
+class Recorder {
+    public:
+        Recorder(const RecordConfig& cfg, const std::vector<MetricConfig>& metrics);
+        ~Recorder();
+
+        Recorder(const Recorder&) = delete;
+        Recorder& operator = (const Recorder&) = delete;
+
+        // Called from the sampling loop. Does not allocate; drops the record if the queue is full.
+        void append(std::size_t metric_idx, std::chrono::steady_clock::time_point now, double value);
+        // Wakes the writer thread; it also writes on its own every 500 ms.
+        void flush();
+
+        std::uint64_t dropped() const noexcept { return dropped_.load(std::memory_order_relaxed); }
+        std::uint64_t write_errors() const noexcept { return write_errors_.load(std::memory_order_relaxed); }
+
+    private:
+        struct Pending {
+            std::size_t metric_idx;
+            replay_format::Record rec;
+        };
+
+        struct Output {
+            std::string stem; // sanitized metric name, empty if not recorded
+            std::FILE* file = nullptr;
+            std::uint64_t bytes = 0;
+        };
+
+        std::string directory_;
+        std::uint64_t max_file_bytes_;
+        int max_files_;
+        std::vector<Output> outputs_; // by metric index; only touched by the writer after construction
+        std::chrono::steady_clock::time_point start_ = std::chrono::steady_clock::now();
+
+        std::mutex mtx_;
+        std::condition_variable cv_;
+        std::vector<Pending> queue_; // reserved up front, swapped with batch_ by the writer
+        std::vector<Pending> batch_;
+        bool wake_ = false;
+        bool stop_ = false;
+        std::thread writer_;
+
+        std::atomic<std::uint64_t> dropped_ {0};
+        std::atomic<std::uint64_t> write_errors_ {0};
+
+        void open_(Output& out);
+        void close_(Output& out);
+        void prune_(const Output& out) const;
+        void write_(const std::vector<Pending>& batch);
+        void run_();
+};
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+
+// On-disk format shared by Recorder and ReplaySensor: one file per metric,
+// a fixed header followed by fixed-size records in time order.
+namespace replay_format {
+
+    inline constexpr char kMagic[8] = {'T', 'L', 'M', 'R', 'E', 'C', '0', '1'};
+    inline constexpr std::uint32_t kVersion = 1;
+
+    struct Header {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t record_size;
+    };
+
+    struct Record {
+        std::int64_t t_us; // since recording start
+        double value;
+    };
+
+    static_assert(sizeof(Header) == 16);
+    static_assert(sizeof(Record) == 16);
+
+} // namespace replay_format
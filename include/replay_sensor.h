@@ -0,0 +1,44 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+#include "sensor.h"
+#include "replay_format.h"
+
+// Plays back a file written by Recorder.
+// speed 1.0 = real time, N = N times faster, 0 = one record per sample() as fast as the loop runs.
+// With speed > 0 every record is played in order: sample() returns the next due record and
+// has_pending() reports whether more are due, so several records can go out per loop period.
+class ReplaySensor final : public ISensor {
+    public:
+        ReplaySensor(std::string metric, std::string unit, std::string path, double speed, bool loop);
+        ~ReplaySensor() override;
+
+        ReplaySensor(const ReplaySensor&) = delete;
+        ReplaySensor& operator = (const ReplaySensor&) = delete;
+
+        bool init() override;
+        std::optional<Reading> sample() override;
+        std::string_view name() const override;
+        bool has_pending() const override;
+
+    private:
+        std::string metric_;
+        std::string unit_;
+        std::string path_;
+        double speed_;
+        bool loop_;
+
+        void* map_ = nullptr;
+        std::size_t map_len_ = 0;
+        const replay_format::Record* records_ = nullptr;
+        std::size_t count_ = 0;
+
+        std::size_t next_ = 0;
+        std::chrono::steady_clock::time_point play_start_ {};
+        double playhead_us_ = 0.0; // scaled time since play_start_, as of the last sample()
+
+        bool due_(std::size_t idx) const;
+};
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct MetricConfig;
+struct RuleConfig;
+
+struct RuleEvent {
+    std::string_view rule;
+    std::string_view metric;
+    std::string_view state; // "fired" | "cleared"
+    double value; // latest value of `metric`, whichever metric triggered the evaluation
+    std::string_view with_metric; // band rules with a second metric, empty otherwise
+    double with_value = 0.0;
+};
+
+// Evaluates compiled per-metric rules inline after each sample.
+// All state is sized at construction; evaluate() does not allocate once `out` has capacity.
+class RuleEngine {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        RuleEngine(const std::vector<RuleConfig>& rules, const std::vector<MetricConfig>& metrics);
+
+        // metric_idx is the metric's position in AppConfig::metrics. Appends transitions to `out`.
+        std::size_t evaluate(std::size_t metric_idx, double value, Clock::time_point now, std::vector<RuleEvent>& out);
+
+        bool empty() const noexcept { return rules_.empty(); }
+        std::size_t size() const noexcept { return rules_.size(); }
+
+    private:
+        enum class Kind { Threshold, Rate, Band };
+        enum class Op { Gt, Ge, Lt, Le };
+
+        struct CompiledRule {
+            std::string name;
+            std::string metric_name;
+            Kind kind;
+            Op op;
+            double value;
+
+            std::size_t metric;
+            double low;
+            double high;
+
+            bool has_with = false;
+            std::string with_metric_name;
+            std::size_t with_metric = 0;
+            double with_low = 0.0;
+            double with_high = 0.0;
+
+            Clock::duration hold;
+
+            // runtime state
+            Clock::time_point pending_since {};
+            bool active = false;
+            bool has_prev = false;
+            double prev_value = 0.0;
+            Clock::time_point prev_time {};
+        };
+
+        std::vector<CompiledRule> rules_;
+        std::vector<std::vector<std::size_t>> by_metric_; // metric index -> rule indices
+        std::vector<double> latest_;
+        std::vector<bool> has_latest_;
+
+        static bool compare_(Op op, double lhs, double rhs) noexcept;
+        bool condition_(CompiledRule& rule, std::size_t metric_idx, double value, Clock::time_point now);
+        RuleEvent make_event_(const CompiledRule& rule, std::string_view state) const noexcept;
+};
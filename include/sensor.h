@@ -16,4 +16,8 @@ class ISensor {
         virtual bool init() = 0;
         virtual std::optional<Reading> sample() = 0;
         virtual std::string_view name() const = 0;
+
+        // True if another reading is already due, so the loop should call sample() again before
+        // sleeping (a replay running faster than the loop period). Most sensors have one per period.
+        virtual bool has_pending() const { return false; }
 };
\ No newline at end of file
@@ -4,7 +4,7 @@
 #include <cstdint>
 #include <string_view>
 
-std::int64_t unix_time_s();
+#include "telemetry_payload.h"
 
 inline nlohmann::json make_status_payload_v1(std::string_view client_id, std::string_view state) {
     return {
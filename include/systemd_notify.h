@@ -0,0 +1,41 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+// Minimal sd_notify(3) implementation over $NOTIFY_SOCKET (no libsystemd dependency).
+// All calls are no-ops when the daemon is not started by systemd with Type=notify.
+class SystemdNotifier {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        SystemdNotifier();
+        ~SystemdNotifier();
+
+        SystemdNotifier(const SystemdNotifier&) = delete;
+        SystemdNotifier& operator = (const SystemdNotifier&) = delete;
+
+        bool enabled() const noexcept { return fd_ >= 0; }
+        bool watchdog_enabled() const noexcept { return enabled() && watchdog_interval_.count() > 0; }
+
+        bool notify(std::string_view state);
+
+        void ready();
+        void status(std::string_view text);
+        void stopping();
+
+        // Sends WATCHDOG=1 at most every WATCHDOG_USEC/2. Call only after the sampling loop made progress.
+        void watchdog(Clock::time_point now);
+
+    private:
+        int fd_ = -1;
+        sockaddr_un addr_ {};
+        socklen_t addr_len_ = 0;
+
+        bool ready_sent_ = false;
+        std::chrono::microseconds watchdog_interval_ {0};
+        Clock::time_point next_watchdog_ {};
+};
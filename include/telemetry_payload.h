@@ -12,6 +12,12 @@ inline std::int64_t unix_time_s() {
     ).count();
 }
 
+inline std::int64_t unix_time_ms() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()
+    ).count();
+}
+
 inline nlohmann::json make_payload_v1(
     std::string_view client_id,
     std::string_view metric_name,
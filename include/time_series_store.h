@@ -0,0 +1,69 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "gorilla.h"
+
+struct SeriesPoint {
+    std::int64_t t_ms;
+    double value;
+};
+
+struct SeriesBucket {
+    std::int64_t t_ms; // bucket start
+    double min;
+    double max;
+    double avg;
+    std::uint64_t count;
+};
+
+// Keeps the last `retention` of every metric in Gorilla-compressed chunks.
+// append() is called from the sampling loop; queries may run concurrently from another thread
+// and hold a series lock only while copying the chunks they need.
+class TimeSeriesStore {
+    public:
+        TimeSeriesStore(const std::vector<std::string>& metric_names,
+                        std::chrono::hours retention,
+                        std::chrono::milliseconds chunk_span = std::chrono::hours(1));
+
+        void append(std::size_t metric_idx, std::int64_t t_ms, double value);
+
+        std::optional<SeriesPoint> latest(std::string_view metric) const;
+        // Return false if the metric is unknown.
+        bool range(std::string_view metric, std::int64_t from_ms, std::int64_t to_ms, std::vector<SeriesPoint>& out) const;
+        // Buckets are step_ms wide and aligned to the unix epoch.
+        bool downsample(std::string_view metric, std::int64_t from_ms, std::int64_t to_ms, std::int64_t step_ms,
+                        std::vector<SeriesBucket>& out) const;
+
+        std::vector<std::string> metrics() const;
+
+        struct Stats {
+            std::uint64_t points = 0;
+            std::uint64_t bytes = 0;
+        };
+        Stats stats() const;
+
+    private:
+        struct Series {
+            std::string name;
+            mutable std::mutex mtx;
+            std::deque<GorillaChunk> chunks;
+            std::optional<SeriesPoint> latest;
+        };
+
+        std::vector<std::unique_ptr<Series>> series_;
+        std::int64_t retention_ms_;
+        std::int64_t chunk_span_ms_;
+
+        const Series* find_(std::string_view metric) const;
+        std::vector<GorillaChunk> snapshot_(const Series& series, std::int64_t from_ms, std::int64_t to_ms) const;
+};
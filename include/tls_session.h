@@ -0,0 +1,49 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+typedef struct ssl_ctx_st SSL_CTX;
+typedef struct ssl_session_st SSL_SESSION;
+typedef struct ssl_st SSL;
+
+// Owns the SSL_CTX handed to libmosquitto (MOSQ_OPT_SSL_CTX). libmosquitto creates a fresh SSL
+// per connect and never resumes sessions itself, so this keeps the last session from the broker
+// and re-applies it when the next handshake starts. It also times every handshake.
+// Only functional when built with TELEMETRY_HAVE_OPENSSL.
+class TlsSessionCache {
+    public:
+        TlsSessionCache();
+        ~TlsSessionCache();
+
+        TlsSessionCache(const TlsSessionCache&) = delete;
+        TlsSessionCache& operator = (const TlsSessionCache&) = delete;
+
+        SSL_CTX* ctx() const noexcept { return ctx_; }
+
+        std::uint64_t handshakes() const noexcept { return handshakes_.load(std::memory_order_relaxed); }
+        std::uint64_t resumed() const noexcept { return resumed_.load(std::memory_order_relaxed); }
+        std::uint64_t last_handshake_us() const noexcept { return last_us_.load(std::memory_order_relaxed); }
+        std::uint64_t total_handshake_us() const noexcept { return total_us_.load(std::memory_order_relaxed); }
+
+    private:
+        SSL_CTX* ctx_ = nullptr;
+
+        std::mutex mtx_;
+        SSL_SESSION* session_ = nullptr;
+
+        // Handshakes start on whichever thread calls mosquitto_connect_async/reconnect_async (connect()
+        // or tick() on the sampling thread) or on libmosquitto's loop thread, and finish there; hence atomics.
+        std::atomic<std::int64_t> started_ns_ {0}; // steady_clock
+        std::atomic<bool> in_handshake_ {false};
+
+        std::atomic<std::uint64_t> handshakes_ {0};
+        std::atomic<std::uint64_t> resumed_ {0};
+        std::atomic<std::uint64_t> last_us_ {0};
+        std::atomic<std::uint64_t> total_us_ {0};
+
+        static TlsSessionCache* from_(const SSL* ssl);
+        static int on_new_session_(SSL* ssl, SSL_SESSION* session);
+        static void on_info_(const SSL* ssl, int where, int ret);
+};
@@ -27,4 +27,18 @@ inline std::string make_status_topic(std::string_view client_id) {
 [[nodiscard]]
 inline std::string make_health_topic(std::string_view client_id) {
     return make_topic(client_id, "health");
+}
+
+[[nodiscard]]
+inline std::string make_events_topic(std::string_view client_id) {
+    return make_topic(client_id, "events");
+}
+
+[[nodiscard]]
+inline std::string make_subtopic(std::string_view client_id, std::string_view metric, std::string_view leaf) {
+    std::string str = make_topic(client_id, metric);
+    str.reserve(str.size() + 1 + leaf.size());
+    str.push_back('/');
+    str.append(leaf);
+    return str;
 }
\ No newline at end of file
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "app_config.h"
+#include "dsp_kernels.h"
+
+struct WaveformFeatures {
+    double rms = 0.0;
+    double peak = 0.0;
+    double crest_factor = 0.0;
+    double mean = 0.0;
+    std::vector<double> band_energy; // mean-square per band, same order as WaveformConfig::bands
+};
+
+// High-rate block channel. A producer thread fills one of two preallocated buffers while the
+// sampling loop processes the other; blocks that arrive before the previous one was taken are dropped.
+class WaveformChannel {
+    public:
+        WaveformChannel(std::string metric, std::string unit, WaveformConfig cfg);
+        ~WaveformChannel();
+
+        WaveformChannel(const WaveformChannel&) = delete;
+        WaveformChannel& operator = (const WaveformChannel&) = delete;
+
+        bool start();
+        void stop() noexcept;
+
+        // Processes the latest completed block, if any. Does not allocate.
+        bool poll(WaveformFeatures& out);
+
+        // Thread-safe; the next processed block is copied for take_snippet().
+        void request_snippet() noexcept { snippet_requested_.store(true, std::memory_order_relaxed); }
+        bool take_snippet(std::vector<float>& out);
+
+        std::string_view name() const noexcept { return metric_; }
+        std::string_view unit() const noexcept { return unit_; }
+        const WaveformConfig& config() const noexcept { return cfg_; }
+
+        std::uint64_t blocks() const noexcept { return blocks_; }
+        std::uint64_t overruns() const noexcept { return overruns_.load(std::memory_order_relaxed); }
+        // feature-extraction throughput on the sampling core
+        double samples_per_s() const noexcept;
+
+    private:
+        enum : int { kFree = 0, kReady = 1, kConsuming = 2 };
+
+        std::string metric_;
+        std::string unit_;
+        WaveformConfig cfg_;
+        std::size_t n_;
+
+        std::array<std::vector<float>, 2> bufs_;
+        std::atomic<int> handoff_state_ {kFree};
+        int handoff_idx_ = 0; // published by handoff_state_ = kReady
+
+        std::thread producer_;
+        std::atomic<bool> running_ {false};
+        std::atomic<std::uint64_t> overruns_ {0};
+
+        dsp::Fft fft_;
+        std::vector<float> window_;
+        double window_power_ = 0.0;
+        std::vector<float> re_;
+        std::vector<float> im_;
+        std::vector<float> pow_;
+        std::vector<std::pair<std::size_t, std::size_t>> band_bins_;
+
+        std::atomic<bool> snippet_requested_ {false};
+        std::vector<float> snippet_;
+        bool snippet_ready_ = false;
+
+        std::uint64_t blocks_ = 0;
+        std::uint64_t process_ns_ = 0;
+
+        void produce_();
+        void extract_(const std::vector<float>& block, WaveformFeatures& out);
+};
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "telemetry_payload.h"
+#include "waveform_channel.h"
+
+inline nlohmann::json make_waveform_payload_v1(
+    std::string_view client_id,
+    std::string_view metric_name,
+    std::string_view unit,
+    const WaveformConfig& cfg,
+    const WaveformFeatures& features,
+    std::uint64_t seq
+) {
+    auto bands = nlohmann::json::array();
+    for (std::size_t i = 0; i < cfg.bands.size() && i < features.band_energy.size(); ++i) {
+        bands.push_back({{"lo_hz", cfg.bands[i].first}, {"hi_hz", cfg.bands[i].second}, {"energy", features.band_energy[i]}});
+    }
+
+    return {
+        {"schema_version", 1},
+        {"device", {{"client_id", client_id}}},
+        {"metric", {
+            {"name", metric_name},
+            {"unit", unit},
+            {"sample_rate_hz", cfg.sample_rate_hz},
+            {"block_size", cfg.block_size}
+        }},
+        {"features", {
+            {"rms", features.rms},
+            {"peak", features.peak},
+            {"crest_factor", features.crest_factor},
+            {"mean", features.mean},
+            {"bands", bands}
+        }},
+        {"timestamp_s", unix_time_s()},
+        {"seq", seq}
+    };
+}
+
+inline nlohmann::json make_snippet_payload_v1(
+    std::string_view client_id,
+    std::string_view metric_name,
+    std::string_view unit,
+    int sample_rate_hz,
+    const std::vector<float>& samples,
+    std::uint64_t seq
+) {
+    return {
+        {"schema_version", 1},
+        {"device", {{"client_id", client_id}}},
+        {"metric", {{"name", metric_name}, {"unit", unit}, {"sample_rate_hz", sample_rate_hz}}},
+        {"samples", samples},
+        {"timestamp_s", unix_time_s()},
+        {"seq", seq}
+    };
+}
@@ -0,0 +1,391 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "daemon_loop.h"
+#include "logger.h"
+#include "mqtt_client.h"
+#include "telemetry_payload.h"
+#include "topic_builder.h"
+#include "health_payload.h"
+#include "event_payload.h"
+#include "rule_engine.h"
+#include "latency_histogram.h"
+#include "proc_stats.h"
+#include "systemd_notify.h"
+#include "time_series_store.h"
+#include "query_server.h"
+#include "ingest_socket.h"
+#include "recorder.h"
+#include "waveform_payload.h"
+#include "latest_value_table.h"
+#include "sensor_factory.h"
+
+namespace {
+
+    struct AppState {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        std::uint64_t publish_ok = 0;
+        std::uint64_t publish_fail = 0;
+        std::uint64_t events_published = 0;
+        std::uint64_t events_dropped = 0;
+        std::deque<std::string> pending_events; // oldest first, kept across broker outages
+        std::uint64_t rule_evals = 0;
+        LatencyHistogram loop_latency; // per health window
+        LatencyHistogram wake_jitter;  // since start, for comparing realtime settings
+        std::chrono::steady_clock::time_point window_start = start;
+        std::uint64_t window_publish_ok = 0;
+
+        std::uint64_t uptime_s() const {
+            return (std::uint64_t)std::chrono::duration_cast<std::chrono::seconds>(
+                std::chrono::steady_clock::now() - start
+            ).count();
+        }
+    };
+
+    void publish_health(MqttClient& mqtt, 
+                        std::string health_topic,
+                        const AppConfig& cfg, 
+                        const AppState& state, 
+                        const Pipeline& pipeline,
+                        std::uint64_t seq) {
+        const auto* store = pipeline.store;
+        const auto* query_server = pipeline.query_server;
+        const auto* ingest = pipeline.ingest;
+        const auto* recorder = pipeline.recorder;
+
+        const auto now_s = unix_time_s();
+        auto health_payload = make_health_payload_v1(
+            cfg.client_id,
+            state.uptime_s(),
+            seq,
+            state.publish_ok,
+            state.publish_fail,
+            mqtt.reconnects(),
+            now_s
+        );
+        health_payload["counters"]["events_published"] = state.events_published;
+        health_payload["counters"]["events_pending"] = state.pending_events.size();
+        health_payload["counters"]["events_dropped"] = state.events_dropped;
+        health_payload["rules"] = {{"evaluations", state.rule_evals}};
+        health_payload["process"] = {{"rss_kb", read_rss_kb()}};
+        health_payload["loop"] = {
+            {"samples", state.loop_latency.count()},
+            {"p50_us", state.loop_latency.percentile_us(50.0)},
+            {"p99_us", state.loop_latency.percentile_us(99.0)},
+            {"max_us", state.loop_latency.max_us()}
+        };
+        health_payload["jitter"] = {
+            {"samples", state.wake_jitter.count()},
+            {"p50_us", state.wake_jitter.percentile_us(50.0)},
+            {"p99_us", state.wake_jitter.percentile_us(99.0)},
+            {"max_us", state.wake_jitter.max_us()},
+            {"log2_us_buckets", state.wake_jitter.buckets()}
+        };
+        if (store) {
+            const auto stats = store->stats();
+            const std::uint64_t queries = query_server ? query_server->queries() : 0;
+            health_payload["store"] = {
+                {"points", stats.points},
+                {"bytes", stats.bytes},
+                {"bits_per_point", stats.points ? static_cast<double>(stats.bytes * 8) / static_cast<double>(stats.points) : 0.0},
+                {"queries", queries},
+                {"query_us_avg", queries ? query_server->query_ns_total() / queries / 1000 : 0}
+            };
+        }
+        if (ingest) {
+            auto producers = nlohmann::json::array();
+            for (const auto& p : ingest->producers()) {
+                producers.push_back({
+                    {"pid", p.pid},
+                    {"accepted", p.accepted},
+                    {"invalid", p.invalid},
+                    {"rate_limited", p.rate_limited}
+                });
+            }
+            health_payload["ingest"] = {
+                {"datagrams", ingest->datagrams()},
+                {"accepted", ingest->accepted()},
+                {"invalid", ingest->invalid()},
+                {"rate_limited", ingest->rate_limited()},
+                {"producers", producers}
+            };
+        }
+        if (recorder) {
+            health_payload["record"] = {
+                {"dropped", recorder->dropped()},
+                {"write_errors", recorder->write_errors()}
+            };
+        }
+        if (!pipeline.waveforms.empty()) {
+            auto waveforms = nlohmann::json::array();
+            for (const auto& entry : pipeline.waveforms) {
+                waveforms.push_back({
+                    {"metric", entry.channel->name()},
+                    {"blocks", entry.channel->blocks()},
+                    {"overruns", entry.channel->overruns()},
+                    {"samples_per_s_per_core", entry.channel->samples_per_s()},
+                    {"kernels", dsp::isa()}
+                });
+            }
+            health_payload["waveforms"] = waveforms;
+        }
+        health_payload["mqtt"] = {
+            {"connected", mqtt.connected()},
+            {"backoff_ms", mqtt.backoff_ms()},
+            {"last_connect_us", mqtt.last_connect_us()}
+        };
+        if (const auto tls = mqtt.tls_stats(); tls.enabled) {
+            health_payload["tls"] = {
+                {"session_resumption", tls.resumption},
+                {"handshakes", tls.handshakes},
+                {"resumed", tls.resumed},
+                {"last_handshake_us", tls.last_handshake_us},
+                {"avg_handshake_us", tls.handshakes ? tls.total_handshake_us / tls.handshakes : 0}
+            };
+        }
+        (void)mqtt.publish(health_topic, health_payload.dump(), /*qos*/ 1, /*retain*/ true);
+    }
+
+    constexpr std::size_t kMaxPendingEvents = 256;
+
+    // Bound on readings taken from one sensor per loop iteration; a replay that is further
+    // behind than this falls behind real time instead of stalling the loop.
+    constexpr std::size_t kMaxReadingsPerSensor = 1024;
+
+    // Sends queued events in order; stops at the first failure so a later "cleared" never overtakes its "fired".
+    void flush_events(MqttClient& mqtt, const std::string& events_topic, AppState& state) {
+        while (!state.pending_events.empty()) {
+            if (!mqtt.publish(events_topic, state.pending_events.front(), /*qos*/ 1, /*retain*/ false)) return;
+            state.pending_events.pop_front();
+            ++state.events_published;
+        }
+    }
+
+    void evaluate_rules(MqttClient& mqtt,
+                        RuleEngine& rules,
+                        std::vector<RuleEvent>& events,
+                        const std::string& events_topic,
+                        const AppConfig& cfg,
+                        AppState& state,
+                        std::size_t metric_idx,
+                        double value,
+                        std::uint64_t seq) {
+        events.clear();
+        rules.evaluate(metric_idx, value, std::chrono::steady_clock::now(), events);
+        ++state.rule_evals;
+
+        // events bypass the telemetry path and go out immediately at QoS 1, or are queued while disconnected
+        for (const auto& event : events) {
+            auto payload = make_event_payload_v1(cfg.client_id, event.rule, event.metric, event.state, event.value, seq);
+            if (!event.with_metric.empty()) payload["with"] = {{"name", event.with_metric}, {"value", event.with_value}};
+
+            if (state.pending_events.size() >= kMaxPendingEvents) {
+                state.pending_events.pop_front();
+                if (state.events_dropped++ == 0) LOG_WARN("Event queue full, dropping oldest events");
+            }
+            state.pending_events.push_back(payload.dump());
+        }
+        if (!events.empty()) flush_events(mqtt, events_topic, state);
+    }
+
+    void publish_reading(MqttClient& mqtt,
+                         const std::string& topic,
+                         const AppConfig& cfg,
+                         AppState& state,
+                         const Reading& reading,
+                         std::uint64_t seq) {
+        auto payload = make_payload_v1(cfg.client_id,
+                                    reading.metric_name,
+                                    reading.unit,
+                                    reading.value,
+                                    seq);
+
+        const bool ok = mqtt.publish(topic, payload.dump(), cfg.qos, cfg.retain);
+        if (ok) ++state.publish_ok;
+        else { ++state.publish_fail; LOG_DEBUG("Failed to publish topic: " + topic); }
+    }
+
+    void report_status(SystemdNotifier& notifier, const MqttClient& mqtt, AppState& state) {
+        const auto now = std::chrono::steady_clock::now();
+        const double window_s = std::chrono::duration<double>(now - state.window_start).count();
+        const double rate = window_s > 0.0 ? static_cast<double>(state.publish_ok - state.window_publish_ok) / window_s : 0.0;
+
+        char buf[160];
+        std::snprintf(buf, sizeof(buf), "%s, %.1f msg/s, ok=%llu fail=%llu reconnects=%llu",
+                      mqtt.connected() ? "connected" : "disconnected",
+                      rate,
+                      static_cast<unsigned long long>(state.publish_ok),
+                      static_cast<unsigned long long>(state.publish_fail),
+                      static_cast<unsigned long long>(mqtt.reconnects()));
+        notifier.status(buf);
+
+        state.window_start = now;
+        state.window_publish_ok = state.publish_ok;
+    }
+
+    void poll_waveforms(MqttClient& mqtt, const AppConfig& cfg, AppState& state, std::vector<WaveformEntry>& waveforms,
+                        std::vector<float>& snippet, std::uint64_t seq) {
+        for (auto& entry : waveforms) {
+            auto& channel = *entry.channel;
+            if (!channel.poll(entry.features)) continue;
+
+            auto payload = make_waveform_payload_v1(cfg.client_id, channel.name(), channel.unit(), channel.config(), entry.features, seq);
+            if (mqtt.publish(entry.topic, payload.dump(), cfg.qos, cfg.retain)) ++state.publish_ok;
+            else ++state.publish_fail;
+
+            if (channel.take_snippet(snippet)) {
+                auto raw = make_snippet_payload_v1(cfg.client_id, channel.name(), channel.unit(), channel.config().sample_rate_hz, snippet, seq);
+                if (mqtt.publish(entry.snippet_topic, raw.dump(), /*qos*/ 1, /*retain*/ false)) ++state.publish_ok;
+                else ++state.publish_fail;
+            }
+        }
+    }
+} // namespace
+
+std::vector<SensorEntry> build_sensors(const AppConfig& cfg) {
+    std::vector<SensorEntry> sensors;
+    sensors.reserve(cfg.metrics.size());
+
+    for (std::size_t i = 0; i < cfg.metrics.size(); ++i) {
+        const auto& metric = cfg.metrics[i];
+        if (metric.type == "waveform") continue; // block channels, see build_waveforms()
+
+        auto sensor = make_sensor(metric); 
+        if (!sensor || !sensor->init()) {
+            throw std::runtime_error("Sensor init failed: " + std::string(sensor ? sensor->name() : "null"));
+        }
+        sensors.push_back(SensorEntry {
+            make_topic(cfg.client_id, metric.topic_suffix),
+            std::move(sensor),
+            i
+        });
+    }
+    return sensors;
+}
+
+std::vector<WaveformEntry> build_waveforms(const AppConfig& cfg) {
+    std::vector<WaveformEntry> waveforms;
+
+    for (const auto& metric : cfg.metrics) {
+        if (metric.type != "waveform") continue;
+
+        // not started here: main() starts them before the sampling thread's CPU mask and RT policy are applied
+        auto channel = std::make_unique<WaveformChannel>(metric.name, metric.unit, metric.waveform);
+        waveforms.push_back(WaveformEntry {
+            make_topic(cfg.client_id, metric.topic_suffix),
+            make_subtopic(cfg.client_id, metric.topic_suffix, "raw"),
+            std::move(channel),
+            {}
+        });
+    }
+    return waveforms;
+}
+
+void subscribe_snippet_requests(MqttClient& mqtt, const AppConfig& cfg, std::vector<WaveformEntry>& waveforms) {
+    for (std::size_t i = 0; i < waveforms.size(); ++i) {
+        const auto& metric = *std::find_if(cfg.metrics.begin(), cfg.metrics.end(),
+            [&](const MetricConfig& m) { return m.name == waveforms[i].channel->name(); });
+        WaveformChannel* channel = waveforms[i].channel.get();
+        mqtt.subscribe(make_subtopic(cfg.client_id, metric.topic_suffix, "snippet_request"),
+                       [channel](std::string_view, std::string_view) { channel->request_snippet(); });
+    }
+}
+
+int run_loop(MqttClient& mqtt, const AppConfig& cfg, std::vector<SensorEntry>& sensors, Pipeline& pipeline,
+             const std::atomic<bool>& running) {
+    auto& rules = pipeline.rules;
+    auto& notifier = pipeline.notifier;
+    auto* store = pipeline.store;
+    auto* ingest = pipeline.ingest;
+    auto* recorder = pipeline.recorder;
+    auto* latest = pipeline.latest;
+
+    AppState state;
+    std::uint64_t seq = 0;
+    constexpr std::uint64_t health_every = 5;
+    const std::string health_topic = make_health_topic(cfg.client_id);
+    const std::string events_topic = make_events_topic(cfg.client_id);
+
+    std::vector<RuleEvent> events;
+    events.reserve(rules.size());
+    std::vector<Reading> ingested;
+    std::vector<float> snippet;
+
+    const auto fault_every = std::chrono::seconds(cfg.fault_disconnect_every_s);
+    auto next_fault = std::chrono::steady_clock::now() + fault_every;
+
+    const auto interval = std::chrono::milliseconds(cfg.interval_ms);
+    auto next_wake = std::chrono::steady_clock::now();
+
+    while (running.load(std::memory_order_relaxed)) {
+        const auto loop_start = std::chrono::steady_clock::now();
+        if (seq > 0) state.wake_jitter.record(loop_start - next_wake);
+
+        if (cfg.fault_disconnect_every_s > 0 && loop_start >= next_fault) {
+            mqtt.drop_connection();
+            next_fault = loop_start + fault_every;
+        }
+
+        mqtt.tick();
+        if (!state.pending_events.empty()) flush_events(mqtt, events_topic, state);
+
+        for (auto& entry : sensors) {
+            const std::size_t i = entry.metric_idx;
+
+            // a fast replay can have several records due per period; publish each of them
+            for (std::size_t n = 0; n < kMaxReadingsPerSensor; ++n) {
+                auto reading = entry.sensor->sample();
+                if (!reading) break;
+
+                if (recorder) recorder->append(i, std::chrono::steady_clock::now(), reading->value);
+                const std::int64_t t_ms = (latest || store) ? unix_time_ms() : 0;
+                if (latest) latest->update(i, reading->value, t_ms, seq);
+                if (store) store->append(i, t_ms, reading->value);
+                if (!rules.empty()) evaluate_rules(mqtt, rules, events, events_topic, cfg, state, i, reading->value, seq);
+
+                publish_reading(mqtt, entry.topic, cfg, state, *reading, seq);
+                if (!entry.sensor->has_pending()) break;
+            }
+        }
+
+        poll_waveforms(mqtt, cfg, state, pipeline.waveforms, snippet, seq);
+
+        // readings from local producers share the same payload and publish path
+        if (ingest) {
+            ingested.clear();
+            ingest->drain(ingested, std::chrono::steady_clock::now());
+            for (const auto& reading : ingested) {
+                publish_reading(mqtt, make_topic(cfg.client_id, reading.metric_name), cfg, state, reading, seq);
+            }
+        }
+
+        const auto loop_end = std::chrono::steady_clock::now();
+        state.loop_latency.record(loop_end - loop_start);
+
+        // ready once telemetry actually flows; watchdog only while the sampling loop progresses
+        if (state.publish_ok > 0) notifier.ready();
+        notifier.watchdog(loop_end);
+
+        if ((seq % health_every) == 0) {
+            publish_health(mqtt, health_topic, cfg, state, pipeline, seq);
+            report_status(notifier, mqtt, state);
+            if (recorder) recorder->flush();
+            state.loop_latency.reset();
+        }
+        ++seq;
+
+        // fixed-period schedule; resync instead of bursting if we fell a whole period behind
+        next_wake += interval;
+        const auto now = std::chrono::steady_clock::now();
+        if (now - next_wake > interval) next_wake = now;
+        std::this_thread::sleep_until(next_wake);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,220 @@
+#include <bit>
+#include <cmath>
+#include <numbers>
+#include <stdexcept>
+#include <utility>
+
+#if defined(__SSE2__)
+    #include <emmintrin.h>
+    #define DSP_SSE2 1
+#elif defined(__ARM_NEON)
+    #include <arm_neon.h>
+    #define DSP_NEON 1
+#endif
+
+#include "dsp_kernels.h"
+
+namespace dsp {
+
+    std::string_view isa() {
+        #if defined(DSP_SSE2)
+            return "sse2";
+        #elif defined(DSP_NEON)
+            return "neon";
+        #else
+            return "scalar";
+        #endif
+    }
+
+    double sum(const float* x, std::size_t n) {
+        std::size_t i = 0;
+        double total = 0.0;
+
+        #if defined(DSP_SSE2)
+            __m128 acc = _mm_setzero_ps();
+            for (; i + 4 <= n; i += 4) acc = _mm_add_ps(acc, _mm_loadu_ps(x + i));
+            alignas(16) float lanes[4];
+            _mm_store_ps(lanes, acc);
+            total = static_cast<double>(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+        #elif defined(DSP_NEON)
+            float32x4_t acc = vdupq_n_f32(0.0f);
+            for (; i + 4 <= n; i += 4) acc = vaddq_f32(acc, vld1q_f32(x + i));
+            float lanes[4];
+            vst1q_f32(lanes, acc);
+            total = static_cast<double>(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+        #endif
+
+        for (; i < n; ++i) total += x[i];
+        return total;
+    }
+
+    double sum_squares(const float* x, std::size_t n) {
+        std::size_t i = 0;
+        double total = 0.0;
+
+        #if defined(DSP_SSE2)
+            __m128 acc = _mm_setzero_ps();
+            for (; i + 4 <= n; i += 4) {
+                const __m128 v = _mm_loadu_ps(x + i);
+                acc = _mm_add_ps(acc, _mm_mul_ps(v, v));
+            }
+            alignas(16) float lanes[4];
+            _mm_store_ps(lanes, acc);
+            total = static_cast<double>(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+        #elif defined(DSP_NEON)
+            float32x4_t acc = vdupq_n_f32(0.0f);
+            for (; i + 4 <= n; i += 4) {
+                const float32x4_t v = vld1q_f32(x + i);
+                acc = vmlaq_f32(acc, v, v);
+            }
+            float lanes[4];
+            vst1q_f32(lanes, acc);
+            total = static_cast<double>(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+        #endif
+
+        for (; i < n; ++i) total += static_cast<double>(x[i]) * x[i];
+        return total;
+    }
+
+    float max_abs(const float* x, std::size_t n) {
+        std::size_t i = 0;
+        float peak = 0.0f;
+
+        #if defined(DSP_SSE2)
+            const __m128 sign_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+            __m128 acc = _mm_setzero_ps();
+            for (; i + 4 <= n; i += 4) acc = _mm_max_ps(acc, _mm_and_ps(_mm_loadu_ps(x + i), sign_mask));
+            alignas(16) float lanes[4];
+            _mm_store_ps(lanes, acc);
+            peak = std::fmax(std::fmax(lanes[0], lanes[1]), std::fmax(lanes[2], lanes[3]));
+        #elif defined(DSP_NEON)
+            float32x4_t acc = vdupq_n_f32(0.0f);
+            for (; i + 4 <= n; i += 4) acc = vmaxq_f32(acc, vabsq_f32(vld1q_f32(x + i)));
+            float lanes[4];
+            vst1q_f32(lanes, acc);
+            peak = std::fmax(std::fmax(lanes[0], lanes[1]), std::fmax(lanes[2], lanes[3]));
+        #endif
+
+        for (; i < n; ++i) peak = std::fmax(peak, std::fabs(x[i]));
+        return peak;
+    }
+
+    void multiply(const float* a, const float* b, float* out, std::size_t n) {
+        std::size_t i = 0;
+
+        #if defined(DSP_SSE2)
+            for (; i + 4 <= n; i += 4) _mm_storeu_ps(out + i, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        #elif defined(DSP_NEON)
+            for (; i + 4 <= n; i += 4) vst1q_f32(out + i, vmulq_f32(vld1q_f32(a + i), vld1q_f32(b + i)));
+        #endif
+
+        for (; i < n; ++i) out[i] = a[i] * b[i];
+    }
+
+    void power(const float* re, const float* im, float* out, std::size_t n) {
+        std::size_t i = 0;
+
+        #if defined(DSP_SSE2)
+            for (; i + 4 <= n; i += 4) {
+                const __m128 r = _mm_loadu_ps(re + i);
+                const __m128 m = _mm_loadu_ps(im + i);
+                _mm_storeu_ps(out + i, _mm_add_ps(_mm_mul_ps(r, r), _mm_mul_ps(m, m)));
+            }
+        #elif defined(DSP_NEON)
+            for (; i + 4 <= n; i += 4) {
+                const float32x4_t r = vld1q_f32(re + i);
+                const float32x4_t m = vld1q_f32(im + i);
+                vst1q_f32(out + i, vmlaq_f32(vmulq_f32(r, r), m, m));
+            }
+        #endif
+
+        for (; i < n; ++i) out[i] = re[i] * re[i] + im[i] * im[i];
+    }
+
+    Fft::Fft(std::size_t n) : n_(n), bitrev_(n), tw_re_(n - 1), tw_im_(n - 1) {
+        if (n < 2 || !std::has_single_bit(n)) throw std::runtime_error("FFT size must be a power of two >= 2");
+
+        const int bits = std::countr_zero(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            std::size_t r = 0;
+            for (int b = 0; b < bits; ++b) r |= ((i >> b) & 1u) << (bits - 1 - b);
+            bitrev_[i] = r;
+        }
+
+        // twiddles stored per stage so the butterfly loop reads them contiguously:
+        // the stage with half-length h uses tw[h - 1 .. 2h - 2] = exp(-2*pi*i*k / 2h), k < h
+        for (std::size_t half = 1; half < n; half <<= 1) {
+            for (std::size_t k = 0; k < half; ++k) {
+                const double angle = -std::numbers::pi * static_cast<double>(k) / static_cast<double>(half);
+                tw_re_[half - 1 + k] = static_cast<float>(std::cos(angle));
+                tw_im_[half - 1 + k] = static_cast<float>(std::sin(angle));
+            }
+        }
+    }
+
+    void Fft::forward(float* re, float* im) const {
+        for (std::size_t i = 0; i < n_; ++i) {
+            const std::size_t j = bitrev_[i];
+            if (i < j) {
+                std::swap(re[i], re[j]);
+                std::swap(im[i], im[j]);
+            }
+        }
+
+        for (std::size_t half = 1; half < n_; half <<= 1) {
+            const float* wr = tw_re_.data() + half - 1;
+            const float* wi = tw_im_.data() + half - 1;
+
+            for (std::size_t base = 0; base < n_; base += 2 * half) {
+                float* ar = re + base;
+                float* ai = im + base;
+                float* br = ar + half;
+                float* bi = ai + half;
+                std::size_t k = 0;
+
+                // four butterflies at a time once a stage is at least four wide
+                #if defined(DSP_SSE2)
+                    for (; k + 4 <= half; k += 4) {
+                        const __m128 w_r = _mm_loadu_ps(wr + k);
+                        const __m128 w_i = _mm_loadu_ps(wi + k);
+                        const __m128 b_r = _mm_loadu_ps(br + k);
+                        const __m128 b_i = _mm_loadu_ps(bi + k);
+                        const __m128 a_r = _mm_loadu_ps(ar + k);
+                        const __m128 a_i = _mm_loadu_ps(ai + k);
+                        const __m128 tr = _mm_sub_ps(_mm_mul_ps(b_r, w_r), _mm_mul_ps(b_i, w_i));
+                        const __m128 ti = _mm_add_ps(_mm_mul_ps(b_r, w_i), _mm_mul_ps(b_i, w_r));
+                        _mm_storeu_ps(br + k, _mm_sub_ps(a_r, tr));
+                        _mm_storeu_ps(bi + k, _mm_sub_ps(a_i, ti));
+                        _mm_storeu_ps(ar + k, _mm_add_ps(a_r, tr));
+                        _mm_storeu_ps(ai + k, _mm_add_ps(a_i, ti));
+                    }
+                #elif defined(DSP_NEON)
+                    for (; k + 4 <= half; k += 4) {
+                        const float32x4_t w_r = vld1q_f32(wr + k);
+                        const float32x4_t w_i = vld1q_f32(wi + k);
+                        const float32x4_t b_r = vld1q_f32(br + k);
+                        const float32x4_t b_i = vld1q_f32(bi + k);
+                        const float32x4_t a_r = vld1q_f32(ar + k);
+                        const float32x4_t a_i = vld1q_f32(ai + k);
+                        const float32x4_t tr = vmlsq_f32(vmulq_f32(b_r, w_r), b_i, w_i);
+                        const float32x4_t ti = vmlaq_f32(vmulq_f32(b_r, w_i), b_i, w_r);
+                        vst1q_f32(br + k, vsubq_f32(a_r, tr));
+                        vst1q_f32(bi + k, vsubq_f32(a_i, ti));
+                        vst1q_f32(ar + k, vaddq_f32(a_r, tr));
+                        vst1q_f32(ai + k, vaddq_f32(a_i, ti));
+                    }
+                #endif
+
+                for (; k < half; ++k) {
+                    const float tr = br[k] * wr[k] - bi[k] * wi[k];
+                    const float ti = br[k] * wi[k] + bi[k] * wr[k];
+                    br[k] = ar[k] - tr;
+                    bi[k] = ai[k] - ti;
+                    ar[k] += tr;
+                    ai[k] += ti;
+                }
+            }
+        }
+    }
+
+} // namespace dsp
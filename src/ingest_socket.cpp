@@ -0,0 +1,241 @@
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "ingest_socket.h"
+#include "logger.h"
+
+namespace {
+
+    constexpr std::size_t kMaxNameLen = 64;
+    constexpr std::size_t kMaxUnitLen = 16;
+
+    bool valid_unit(std::string_view unit) {
+        if (unit.size() > kMaxUnitLen) return false;
+        return std::all_of(unit.begin(), unit.end(), [](char c) { return c > ' ' && c < 0x7f; });
+    }
+
+    std::string_view next_token(std::string_view& line) {
+        const auto start = line.find_first_not_of(" \t");
+        if (start == std::string_view::npos) { line = {}; return {}; }
+        line.remove_prefix(start);
+        const auto end = line.find_first_of(" \t");
+        const auto token = line.substr(0, end);
+        line.remove_prefix(end == std::string_view::npos ? line.size() : end);
+        return token;
+    }
+
+    bool parse_value(std::string_view token, double& out) {
+        if (token.empty() || token.size() > 32) return false;
+        char buf[33];
+        std::memcpy(buf, token.data(), token.size());
+        buf[token.size()] = '\0';
+        char* end = nullptr;
+        errno = 0;
+        out = std::strtod(buf, &end);
+        return errno == 0 && end == buf + token.size() && std::isfinite(out);
+    }
+
+} // namespace
+
+IngestSocket::IngestSocket(std::string socket_path, double rate_per_s, double burst,
+                           mode_t socket_mode, std::vector<std::string> reserved_names)
+    : socket_path_(std::move(socket_path)), rate_per_s_(rate_per_s), burst_(burst),
+      socket_mode_(socket_mode), reserved_names_(std::move(reserved_names)) {
+    producers_.reserve(kMaxProducers);
+}
+
+IngestSocket::~IngestSocket() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        ::unlink(socket_path_.c_str());
+    }
+}
+
+bool IngestSocket::start() {
+    sockaddr_un addr {};
+    if (socket_path_.empty() || socket_path_.size() >= sizeof(addr.sun_path)) {
+        LOG_ERROR("Invalid ingest socket path: " + socket_path_);
+        return false;
+    }
+
+    fd_ = ::socket(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd_ < 0) {
+        LOG_ERROR(std::string("ingest socket() failed: ") + std::strerror(errno));
+        return false;
+    }
+
+    const int on = 1;
+    (void)::setsockopt(fd_, SOL_SOCKET, SO_PASSCRED, &on, sizeof(on));
+
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, socket_path_.c_str(), socket_path_.size());
+    ::unlink(socket_path_.c_str()); // stale socket from a previous run
+
+    if (::bind(fd_, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0) {
+        LOG_ERROR("ingest socket bind failed on " + socket_path_ + ": " + std::strerror(errno));
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+
+    // bind() applied the umask; producers need write permission to send
+    if (::chmod(socket_path_.c_str(), socket_mode_) != 0) {
+        LOG_ERROR("ingest socket chmod failed on " + socket_path_ + ": " + std::strerror(errno));
+        ::close(fd_);
+        ::unlink(socket_path_.c_str());
+        fd_ = -1;
+        return false;
+    }
+
+    LOG_INFO("Ingest socket listening on " + socket_path_);
+    return true;
+}
+
+// metric names become topic levels, so reject MQTT wildcards and separators, and any level
+// that would publish over the daemon's own topics or a configured metric
+bool IngestSocket::valid_name_(std::string_view name) const {
+    if (name.empty() || name.size() > kMaxNameLen) return false;
+    if (name == "status" || name == "health" || name == "events") return false; // daemon-owned topics
+    if (std::find(reserved_names_.begin(), reserved_names_.end(), name) != reserved_names_.end()) return false;
+    return std::all_of(name.begin(), name.end(), [](char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+               c == '_' || c == '-' || c == '.';
+    });
+}
+
+IngestSocket::Producer& IngestSocket::producer_(pid_t pid, Clock::time_point now) {
+    for (auto& p : producers_) {
+        if (p.stats.pid == pid) return p;
+    }
+
+    if (producers_.size() >= kMaxProducers) {
+        // bounded table: forget the producer we heard from least recently
+        auto oldest = std::min_element(producers_.begin(), producers_.end(),
+            [](const Producer& a, const Producer& b) { return a.last_seen < b.last_seen; });
+        *oldest = Producer{};
+        oldest->stats.pid = pid;
+        oldest->tokens = burst_;
+        oldest->last_seen = now;
+        return *oldest;
+    }
+
+    Producer p;
+    p.stats.pid = pid;
+    p.tokens = burst_;
+    p.last_seen = now;
+    producers_.push_back(p);
+    return producers_.back();
+}
+
+void IngestSocket::parse_datagram_(const char* data, std::size_t len, pid_t pid, Clock::time_point now, std::vector<Reading>& out) {
+    auto& prod = producer_(pid, now);
+
+    const double elapsed_s = std::chrono::duration<double>(now - prod.last_seen).count();
+    prod.tokens = std::min(burst_, prod.tokens + elapsed_s * rate_per_s_);
+    prod.last_seen = now;
+
+    std::string_view rest(data, len);
+    while (!rest.empty()) {
+        const auto nl = rest.find('\n');
+        std::string_view line = rest.substr(0, nl);
+        rest.remove_prefix(nl == std::string_view::npos ? rest.size() : nl + 1);
+        if (line.find_first_not_of(" \t\r") == std::string_view::npos) continue;
+        if (line.back() == '\r') line.remove_suffix(1);
+
+        const auto name = next_token(line);
+        const auto value_tok = next_token(line);
+        const auto unit = next_token(line);
+        const auto extra = next_token(line);
+
+        double value = 0.0;
+        if (!valid_name_(name) || !parse_value(value_tok, value) || !valid_unit(unit) || !extra.empty()) {
+            ++prod.stats.invalid;
+            ++invalid_;
+            continue;
+        }
+
+        if (prod.tokens < 1.0) {
+            ++prod.stats.rate_limited;
+            ++rate_limited_;
+            continue;
+        }
+        prod.tokens -= 1.0;
+
+        out.push_back(Reading{std::string(name), std::string(unit), value});
+        ++prod.stats.accepted;
+        ++accepted_;
+    }
+}
+
+std::size_t IngestSocket::drain(std::vector<Reading>& out, Clock::time_point now, std::size_t max_datagrams) {
+    if (fd_ < 0) return 0;
+
+    std::array<std::array<char, kMaxDatagram>, kBatch> bufs;
+    std::array<std::array<char, CMSG_SPACE(sizeof(ucred))>, kBatch> ctrls;
+    std::array<iovec, kBatch> iovs;
+    std::array<mmsghdr, kBatch> msgs;
+
+    const std::size_t before = out.size();
+    std::size_t total = 0;
+
+    while (total < max_datagrams) {
+        const std::size_t want = std::min(kBatch, max_datagrams - total);
+        for (std::size_t i = 0; i < want; ++i) {
+            iovs[i] = iovec{bufs[i].data(), bufs[i].size()};
+            msgs[i] = mmsghdr{};
+            msgs[i].msg_hdr.msg_iov = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+            msgs[i].msg_hdr.msg_control = ctrls[i].data();
+            msgs[i].msg_hdr.msg_controllen = ctrls[i].size();
+        }
+
+        const int n = ::recvmmsg(fd_, msgs.data(), static_cast<unsigned>(want), MSG_DONTWAIT, nullptr);
+        if (n <= 0) {
+            if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                LOG_DEBUG(std::string("ingest recvmmsg failed: ") + std::strerror(errno));
+            }
+            break;
+        }
+
+        for (int i = 0; i < n; ++i) {
+            auto& hdr = msgs[static_cast<std::size_t>(i)].msg_hdr;
+            pid_t pid = 0;
+            for (cmsghdr* c = CMSG_FIRSTHDR(&hdr); c; c = CMSG_NXTHDR(&hdr, c)) {
+                if (c->cmsg_level == SOL_SOCKET && c->cmsg_type == SCM_CREDENTIALS) {
+                    ucred cred {};
+                    std::memcpy(&cred, CMSG_DATA(c), sizeof(cred));
+                    pid = cred.pid;
+                }
+            }
+
+            ++datagrams_;
+            if (hdr.msg_flags & MSG_TRUNC) {
+                ++invalid_;
+                ++producer_(pid, now).stats.invalid;
+                continue;
+            }
+            parse_datagram_(bufs[static_cast<std::size_t>(i)].data(), msgs[static_cast<std::size_t>(i)].msg_len, pid, now, out);
+        }
+
+        total += static_cast<std::size_t>(n);
+        if (static_cast<std::size_t>(n) < want) break;
+    }
+
+    return out.size() - before;
+}
+
+std::vector<IngestSocket::ProducerStats> IngestSocket::producers() const {
+    std::vector<ProducerStats> stats;
+    stats.reserve(producers_.size());
+    for (const auto& p : producers_) stats.push_back(p.stats);
+    return stats;
+}
@@ -0,0 +1,103 @@
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <new>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "latest_value_table.h"
+#include "app_config.h"
+#include "logger.h"
+
+LatestValueTable::LatestValueTable(std::string shm_name, const std::vector<MetricConfig>& metrics)
+    : shm_name_(std::move(shm_name)) {
+    names_.reserve(metrics.size());
+    for (const auto& m : metrics) names_.emplace_back(m.name, m.unit);
+}
+
+namespace {
+
+    std::uint64_t new_generation() {
+        timespec ts {};
+        clock_gettime(CLOCK_REALTIME, &ts);
+        const auto ns = static_cast<std::uint64_t>(ts.tv_sec) * 1000000000u + static_cast<std::uint64_t>(ts.tv_nsec);
+        return ns != 0 ? ns : 1;
+    }
+
+} // namespace
+
+LatestValueTable::~LatestValueTable() {
+    if (map_) {
+        // readers still mapping this segment see it retired through stale()
+        static_cast<latest_value_shm::Header*>(map_)->generation.store(0, std::memory_order_release);
+        munmap(map_, len_);
+        shm_unlink(shm_name_.c_str());
+    }
+}
+
+bool LatestValueTable::open() {
+    // start from a fresh segment so readers never see a stale layout
+    shm_unlink(shm_name_.c_str());
+
+    const int fd = shm_open(shm_name_.c_str(), O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        LOG_ERROR("shm_open " + shm_name_ + " failed: " + std::strerror(errno));
+        return false;
+    }
+
+    len_ = latest_value_shm::table_size(names_.size());
+    if (ftruncate(fd, static_cast<off_t>(len_)) != 0) {
+        LOG_ERROR("ftruncate " + shm_name_ + " failed: " + std::strerror(errno));
+        close(fd);
+        shm_unlink(shm_name_.c_str());
+        return false;
+    }
+
+    map_ = mmap(nullptr, len_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map_ == MAP_FAILED) {
+        map_ = nullptr;
+        LOG_ERROR("mmap " + shm_name_ + " failed: " + std::strerror(errno));
+        shm_unlink(shm_name_.c_str());
+        return false;
+    }
+
+    auto* base = static_cast<char*>(map_);
+    auto* header = reinterpret_cast<latest_value_shm::Header*>(base);
+    entries_ = reinterpret_cast<latest_value_shm::Entry*>(base + latest_value_shm::entries_offset());
+
+    for (std::size_t i = 0; i < names_.size(); ++i) {
+        auto* e = new (&entries_[i]) latest_value_shm::Entry{};
+        std::memcpy(e->name, names_[i].first.data(), std::min(names_[i].first.size(), latest_value_shm::kNameLen - 1));
+        std::memcpy(e->unit, names_[i].second.data(), std::min(names_[i].second.size(), latest_value_shm::kUnitLen - 1));
+    }
+
+    header->version = latest_value_shm::kVersion;
+    header->entry_count = static_cast<std::uint32_t>(names_.size());
+    header->entry_size = sizeof(latest_value_shm::Entry);
+    std::memcpy(header->magic, latest_value_shm::kMagic, sizeof(header->magic));
+    new (&header->generation) std::atomic<std::uint64_t>(0);
+    header->generation.store(new_generation(), std::memory_order_release);
+
+    LOG_INFO("Latest-value table published at /dev/shm" + shm_name_);
+    return true;
+}
+
+void LatestValueTable::update(std::size_t metric_idx, double value, std::int64_t timestamp_ms, std::uint64_t seq) noexcept {
+    if (!entries_ || metric_idx >= names_.size()) return;
+    auto& e = entries_[metric_idx];
+
+    const std::uint64_t lock = e.lock.load(std::memory_order_relaxed);
+    e.lock.store(lock + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    e.value_bits.store(std::bit_cast<std::uint64_t>(value), std::memory_order_relaxed);
+    e.timestamp_ms.store(timestamp_ms, std::memory_order_relaxed);
+    e.seq.store(seq, std::memory_order_relaxed);
+
+    e.lock.store(lock + 2, std::memory_order_release);
+}
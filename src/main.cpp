@@ -4,23 +4,29 @@
 #include <cstdlib>
 #include <thread>
 #include <vector>
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <unistd.h>
 #include <chrono>
+#include <cstdio>
 #include <stdexcept>
 #include <iostream>
 
 #include <mosquitto.h>
 
 #include "app_config.h"
+#include "daemon_loop.h"
 #include "logger.h"
 #include "mqtt_client.h"
-#include "telemetry_payload.h"
-#include "topic_builder.h"
-#include "health_payload.h"
-#include "sensor_factory.h"
-#include "simulated_sensor.h"
+#include "rule_engine.h"
+#include "systemd_notify.h"
+#include "realtime.h"
+#include "time_series_store.h"
+#include "query_server.h"
+#include "ingest_socket.h"
+#include "recorder.h"
+#include "latest_value_table.h"
 #include "version.h"
 
 static std::atomic<bool> g_running{true};
@@ -66,6 +72,12 @@ namespace {
         return opts;
     };
 
+    std::string octal(unsigned mode) {
+        char buf[8];
+        std::snprintf(buf, sizeof(buf), "%04o", mode);
+        return buf;
+    }
+
     void print_config(const AppConfig& cfg) {
         nlohmann::json out;
         out["log_level"] = cfg.log_level;
@@ -73,11 +85,61 @@ namespace {
         out["interval_ms"] = cfg.interval_ms;
         out["qos"] = cfg.qos;
         out["retain"] = cfg.retain;
+        out["realtime"] = {
+            {"sampling_cpus", cfg.realtime.sampling_cpus},
+            {"network_cpus", cfg.realtime.network_cpus},
+            {"sched_policy", cfg.realtime.sched_policy},
+            {"sched_priority", cfg.realtime.sched_priority},
+            {"lock_memory", cfg.realtime.lock_memory},
+            {"prefault_heap_kb", cfg.realtime.prefault_heap_kb},
+            {"prefault_stack_kb", cfg.realtime.prefault_stack_kb},
+            {"thread_stack_kb", cfg.realtime.thread_stack_kb}
+        };
+        out["store"] = {
+            {"enabled", cfg.store.enabled},
+            {"retention_hours", cfg.store.retention_hours},
+            {"socket_path", cfg.store.socket_path}
+        };
+        out["ingest"] = {
+            {"enabled", cfg.ingest.enabled},
+            {"socket_path", cfg.ingest.socket_path},
+            {"socket_mode", octal(cfg.ingest.socket_mode)},
+            {"rate_per_s", cfg.ingest.rate_per_s},
+            {"burst", cfg.ingest.burst}
+        };
+        if (cfg.record.enabled) {
+            out["record"] = {
+                {"directory", cfg.record.directory},
+                {"max_file_kb", cfg.record.max_file_kb},
+                {"max_files", cfg.record.max_files}
+            };
+        }
+        if (cfg.shm.enabled) {
+            out["shm"] = {{"name", cfg.shm.name}};
+        }
+        if (cfg.fault_disconnect_every_s > 0) {
+            out["faults"] = {{"disconnect_every_s", cfg.fault_disconnect_every_s}};
+        }
         out["broker"] = {
             {"host", cfg.host},
             {"port", cfg.port},
-            {"keepalive_s", cfg.keepalive_s}
+            {"keepalive_s", cfg.keepalive_s},
+            {"reconnect", {
+                {"min_backoff_ms", cfg.reconnect.min_backoff_ms},
+                {"max_backoff_ms", cfg.reconnect.max_backoff_ms}
+            }}
         };
+        if (cfg.tls.enabled) {
+            out["broker"]["tls"] = {
+                {"ca_file", cfg.tls.ca_file},
+                {"cert_file", cfg.tls.cert_file},
+                {"key_file", cfg.tls.key_file},
+                {"alpn", cfg.tls.alpn},
+                {"tls_version", cfg.tls.tls_version},
+                {"insecure", cfg.tls.insecure},
+                {"session_resumption", cfg.tls.session_resumption}
+            };
+        }
 
         for (const auto& m : cfg.metrics) {
             out["metrics"].push_back({
@@ -87,6 +149,15 @@ namespace {
                 {"topic_suffix", m.topic_suffix}
             });
         }
+
+        for (const auto& r : cfg.rules) {
+            out["rules"].push_back({
+                {"name", r.name},
+                {"kind", r.kind},
+                {"metric", r.metric},
+                {"for_ms", r.for_ms}
+            });
+        }
         std::cout << out.dump(2) << "\n";
     }
 
@@ -97,23 +168,6 @@ namespace {
         MosquittoLibGuard& operator=(const MosquittoLibGuard&) = delete;
     };
 
-    struct SensorEntry {
-        std::string topic;
-        std::unique_ptr<ISensor> sensor;
-    };
-
-    struct AppState {
-        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
-        std::uint64_t publish_ok = 0;
-        std::uint64_t publish_fail = 0;
-
-        std::uint64_t uptime_s() const {
-            return (std::uint64_t)std::chrono::duration_cast<std::chrono::seconds>(
-                std::chrono::steady_clock::now() - start
-            ).count();
-        }
-    };
-
     AppConfig load_config(const CliOptions& cli) {
         LOG_INFO("Reading config file (log level will be applied after load)");
         return load_config_or_throw(cli.config_path);
@@ -130,78 +184,27 @@ namespace {
         LOG_INFO("log level is: " + std::string(logger::level_str(lvl)));
     }
 
-    std::vector<SensorEntry> build_sensors(const AppConfig& cfg) {
-        std::vector<SensorEntry> sensors;
-        sensors.reserve(cfg.metrics.size());
-
-        for (const auto& metric : cfg.metrics) {
-            auto sensor = make_sensor(metric); 
-            if (!sensor || !sensor->init()) {
-                throw std::runtime_error("Sensor init failed: " + std::string(sensor ? sensor->name() : "null"));
-            }
-            sensors.push_back(SensorEntry {
-                make_topic(cfg.client_id, metric.topic_suffix),
-                std::move(sensor)
-            });
-        }
-        return sensors;
-    }
-
     void log_config_summary(const AppConfig& cfg) {
         LOG_INFO("Client ID: " + cfg.client_id);
-        LOG_INFO("Broker: " + cfg.host + ":" +std::to_string(cfg.port));
+        LOG_INFO("Broker: " + cfg.host + ":" +std::to_string(cfg.port) + (cfg.tls.enabled ? " (TLS)" : ""));
         LOG_INFO("Interval ms: " + std::to_string(cfg.interval_ms));
         LOG_INFO("Metrics: " + std::to_string(cfg.metrics.size()) + " metrics");
+        LOG_INFO("Rules: " + std::to_string(cfg.rules.size()) + " rules");
     }
 
-    void publish_health(MqttClient& mqtt, 
-                        std::string health_topic,
-                        const AppConfig& cfg, 
-                        const AppState& state, 
-                        std::uint64_t seq) {
-        const auto now_s = unix_time_s();
-        auto health_payload = make_health_payload_v1(
-            cfg.client_id,
-            state.uptime_s(),
-            seq,
-            state.publish_ok,
-            state.publish_fail,
-            mqtt.reconnects(),
-            now_s
-        );
-        (void)mqtt.publish(health_topic, health_payload.dump(), /*qos*/ 1, /*retain*/ true);
-    }
-
-    int run_loop(MqttClient& mqtt, const AppConfig& cfg, std::vector<SensorEntry>& sensors) {
-        AppState state;
-        std::uint64_t seq = 0;
-        constexpr std::uint64_t health_every = 5;
-        const std::string health_topic = make_health_topic(cfg.client_id);
-
-        while (g_running.load(std::memory_order_relaxed)) {
-            mqtt.tick();
-
-            for (auto& entry : sensors) {
-                auto reading = entry.sensor->sample();
-                if (!reading) continue;
-
-                auto payload = make_payload_v1(cfg.client_id,
-                                            reading->metric_name,
-                                            reading->unit,
-                                            reading->value,
-                                            seq);
-                
-                const bool ok = mqtt.publish(entry.topic, payload.dump(), cfg.qos, cfg.retain);
-                if (ok) ++state.publish_ok;
-                else { ++state.publish_fail; LOG_DEBUG("Failed to publish topic: " + entry.topic); }
-            }
+    void apply_sampling_realtime(const RealtimeConfig& rt, const std::vector<int>& original_cpus) {
+        if (!rt.sampling_cpus.empty()) {
+            set_thread_affinity(rt.sampling_cpus);
+        } else if (!rt.network_cpus.empty()) {
+            // undo the temporary network mask on the sampling thread
+            set_thread_affinity(original_cpus);
+        }
 
-            if ((seq % health_every) == 0) publish_health(mqtt, health_topic, cfg, state, seq);
-            ++seq;
-            std::this_thread::sleep_for(std::chrono::milliseconds(cfg.interval_ms));
+        if (rt.sched_policy != "other" && set_thread_scheduling(rt.sched_policy, rt.sched_priority)) {
+            LOG_INFO("Sampling thread scheduling: " + rt.sched_policy + " priority " + std::to_string(rt.sched_priority));
         }
-        return EXIT_SUCCESS;
     }
+
 } // namespace
 
 int main(int argc, char** argv) {
@@ -228,20 +231,100 @@ int main(int argc, char** argv) {
         LOG_INFO("Starting embedded telemetry daemon");
         log_config_summary(cfg);
 
+        // before the first thread: query server, ingest, recorder, waveform producers, MQTT loop
+        if (cfg.realtime.thread_stack_kb > 0) set_default_thread_stack(static_cast<std::size_t>(cfg.realtime.thread_stack_kb));
+
         MosquittoLibGuard mosq_guard;
 
         auto sensors = build_sensors(cfg);
+        RuleEngine rules(cfg.rules, cfg.metrics);
+        SystemdNotifier notifier;
+
+        std::unique_ptr<TimeSeriesStore> store;
+        std::unique_ptr<QueryServer> query_server;
+        if (cfg.store.enabled) {
+            std::vector<std::string> names;
+            for (const auto& m : cfg.metrics) names.push_back(m.name);
+            store = std::make_unique<TimeSeriesStore>(names, std::chrono::hours(cfg.store.retention_hours));
+            query_server = std::make_unique<QueryServer>(*store, cfg.store.socket_path);
+            if (!query_server->start()) query_server.reset();
+        }
+
+        std::unique_ptr<Recorder> recorder;
+        if (cfg.record.enabled) {
+            recorder = std::make_unique<Recorder>(cfg.record, cfg.metrics);
+        }
+
+        std::unique_ptr<LatestValueTable> latest;
+        if (cfg.shm.enabled) {
+            latest = std::make_unique<LatestValueTable>(cfg.shm.name, cfg.metrics);
+            if (!latest->open()) latest.reset();
+        }
+
+        std::unique_ptr<IngestSocket> ingest;
+        if (cfg.ingest.enabled) {
+            std::vector<std::string> reserved;
+            for (const auto& m : cfg.metrics) reserved.push_back(m.topic_suffix);
+            ingest = std::make_unique<IngestSocket>(cfg.ingest.socket_path, cfg.ingest.rate_per_s, cfg.ingest.burst,
+                                                    static_cast<mode_t>(cfg.ingest.socket_mode), std::move(reserved));
+            if (!ingest->start()) ingest.reset();
+        }
+
+        if (cfg.realtime.lock_memory) {
+            if (lock_and_prefault_memory(cfg.realtime.prefault_heap_kb, cfg.realtime.prefault_stack_kb)) {
+                LOG_INFO("Memory locked and prefaulted");
+            }
+        }
+
+        // waveform producers start before any mask or RT policy is applied, so they keep the
+        // daemon's original CPUs and normal scheduling instead of competing with the sampling loop
+        auto waveforms = build_waveforms(cfg);
+        for (auto& entry : waveforms) {
+            if (!entry.channel->start()) throw std::runtime_error("Waveform channel start failed: " + std::string(entry.channel->name()));
+        }
+
+        // the MQTT network thread inherits this mask when connect() starts it; the mask we were
+        // started with (taskset, CPUAffinity=) is restored on the sampling thread afterwards
+        const auto original_cpus = get_thread_affinity();
+        set_thread_affinity(cfg.realtime.network_cpus);
 
         MqttClient mqtt(cfg.host, cfg.port, cfg.client_id, cfg.qos);
+        mqtt.set_reconnect_options(MqttReconnectOptions {
+            std::chrono::milliseconds(cfg.reconnect.min_backoff_ms),
+            std::chrono::milliseconds(cfg.reconnect.max_backoff_ms)
+        });
+        subscribe_snippet_requests(mqtt, cfg, waveforms);
+
+        if (cfg.tls.enabled) {
+            const MqttTlsOptions tls {
+                cfg.tls.ca_file,
+                cfg.tls.cert_file,
+                cfg.tls.key_file,
+                cfg.tls.alpn,
+                cfg.tls.tls_version,
+                cfg.tls.insecure,
+                cfg.tls.session_resumption
+            };
+            if (!mqtt.configure_tls(tls)) {
+                LOG_ERROR("MQTT TLS setup failed");
+                return EXIT_FAILURE;
+            }
+        }
         LOG_INFO("Connecting MQTT...");
+        notifier.status("connecting to " + cfg.host + ":" + std::to_string(cfg.port));
         if (!mqtt.connect(cfg.keepalive_s)) {
             LOG_ERROR("MQTT connect failed");
             return EXIT_FAILURE;
         }
 
-        const int rc = run_loop(mqtt, cfg, sensors);
+        // applied after the network thread exists so it keeps its own mask and normal priority
+        apply_sampling_realtime(cfg.realtime, original_cpus);
+
+        Pipeline pipeline {rules, notifier, waveforms, store.get(), query_server.get(), ingest.get(), recorder.get(), latest.get()};
+        const int rc = run_loop(mqtt, cfg, sensors, pipeline, g_running);
 
         LOG_INFO("Shutting down...");
+        notifier.stopping();
         mqtt.stop();
         return rc;
 
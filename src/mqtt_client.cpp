@@ -4,11 +4,15 @@
 #include <mutex>
 #include <thread>
 #include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sys/socket.h>
 
 #include "mqtt_client.h"
 #include "logger.h"
 #include "topic_builder.h"
 #include "status_payload.h"
+#include "tls_session.h"
 
 MqttClient::MqttClient(std::string host, int port, std::string client_id, int qos) 
     : host_(std::move(host)), port_(port), client_id_(std::move(client_id)), qos_(qos) {
@@ -23,6 +27,7 @@ MqttClient::MqttClient(std::string host, int port, std::string client_id, int qo
         // Call backs
         mosquitto_connect_callback_set(mosq_, &MqttClient::on_connect);
         mosquitto_disconnect_callback_set(mosq_, &MqttClient::on_disconnect);
+        mosquitto_message_callback_set(mosq_, &MqttClient::on_message);
 
         // LWT
         setup_lwt_();
@@ -40,13 +45,27 @@ void MqttClient::on_connect(struct mosquitto* /*mosq*/, void* obj, int rc) {
     auto* self = static_cast<MqttClient*>(obj);
 
     if (rc == 0) {
-        self->connected_.store(true, std::memory_order_relaxed);
-        self->backoff_seconds_ = 1;
-        self->next_reconnect_ = {};
+        const auto started_ns = self->connect_started_ns_.exchange(0, std::memory_order_relaxed);
+        if (started_ns != 0) {
+            const auto now_ns = std::chrono::steady_clock::now().time_since_epoch() / std::chrono::nanoseconds(1);
+            self->last_connect_us_.store(static_cast<std::uint64_t>(now_ns - started_ns) / 1000, std::memory_order_relaxed);
+        }
+
+        {
+            // under tick_reconnect_'s lock, so an attempt it is finishing cannot re-grow the backoff;
+            // connected_ goes up only afterwards, so whoever sees it also sees the reset backoff
+            std::lock_guard<std::mutex> lock(self->reconnect_mtx_);
+            self->backoff_ms_.store(self->reconnect_opts_.min_backoff.count(), std::memory_order_relaxed);
+            self->next_reconnect_ = {};
+            self->connected_.store(true, std::memory_order_release);
+        }
         LOG_INFO("Connected to broker");
 
         // mark online (retained)
         self->publish_status_(self->online_payload_);
+
+        // clean session: the broker forgot our subscriptions
+        self->subscribe_all_();
     } else {
         self->connected_.store(false, std::memory_order_relaxed);
         LOG_ERROR("Connect failed rc=" + std::to_string(rc));
@@ -64,9 +83,22 @@ void MqttClient::on_disconnect(struct mosquitto* /*mosq*/, void* obj, int rc) {
     }
 }
 
+void MqttClient::on_message(struct mosquitto* /*mosq*/, void* obj, const struct mosquitto_message* msg) {
+    auto* self = static_cast<MqttClient*>(obj);
+    if (!msg || !msg->topic) return;
+
+    const std::string_view topic(msg->topic);
+    const std::string_view payload(static_cast<const char*>(msg->payload), msg->payload ? static_cast<std::size_t>(msg->payloadlen) : 0);
+
+    for (const auto& sub : self->subscriptions_) {
+        if (sub.topic == topic) sub.handler(topic, payload);
+    }
+}
+
 bool MqttClient::connect(int keepalive_seconds) {
     if (!mosq_) return false;
 
+    mark_connect_started_();
     int rc = mosquitto_connect_async(mosq_, host_.c_str(), port_, keepalive_seconds);
     if (rc != MOSQ_ERR_SUCCESS) {
         LOG_ERROR(std::string("mosquitto_connect_async error: ") + mosquitto_strerror(rc));
@@ -86,6 +118,11 @@ bool MqttClient::connect(int keepalive_seconds) {
     return true;
 }
 
+void MqttClient::set_reconnect_options(const MqttReconnectOptions& opts) {
+    reconnect_opts_ = opts;
+    backoff_ms_.store(opts.min_backoff.count(), std::memory_order_relaxed);
+}
+
 void MqttClient::tick() { tick_reconnect_(); }
 
 void MqttClient::tick_reconnect_() {
@@ -105,21 +142,25 @@ void MqttClient::tick_reconnect_() {
     std::lock_guard<std::mutex> lock(reconnect_mtx_, std::adopt_lock);
 
     if (connected_.load(std::memory_order_relaxed)) {
-        backoff_seconds_ = 1;
+        backoff_ms_.store(reconnect_opts_.min_backoff.count(), std::memory_order_relaxed);
         next_reconnect_ = {};
         return;
     }
 
+    const auto backoff = std::chrono::milliseconds(backoff_ms_.load(std::memory_order_relaxed));
+    const auto next_backoff = std::min(backoff * 2, reconnect_opts_.max_backoff);
+
+    mark_connect_started_();
     int rc = mosquitto_reconnect_async(mosq_);
     if (rc == MOSQ_ERR_SUCCESS) {
         reconnects_.fetch_add(1, std::memory_order_relaxed);
         // schedule next attempt incase it fails
-        next_reconnect_ = now + std::chrono::seconds(backoff_seconds_);
-        backoff_seconds_ = std::min(backoff_seconds_ * 2, kMaxBackoffSeconds);
+        next_reconnect_ = now + backoff;
+        backoff_ms_.store(next_backoff.count(), std::memory_order_relaxed);
     } else {
         LOG_ERROR(std::string("reconnect_async error: ") + mosquitto_strerror(rc));
-        next_reconnect_ = now + std::chrono::seconds(backoff_seconds_);
-        backoff_seconds_ = std::min(backoff_seconds_ * 2, kMaxBackoffSeconds);
+        next_reconnect_ = now + backoff;
+        backoff_ms_.store(next_backoff.count(), std::memory_order_relaxed);
     }
 }
 
@@ -157,6 +198,22 @@ bool MqttClient::publish(std::string_view topic, std::string_view payload, int q
     return true;
 }
 
+void MqttClient::drop_connection() {
+    if (!mosq_) return;
+    if (stopping_.load(std::memory_order_relaxed)) return;
+    if (!connected_.load(std::memory_order_relaxed)) return;
+
+    const int fd = mosquitto_socket(mosq_);
+    if (fd < 0) return;
+
+    // Cut the stream under libmosquitto instead of sending DISCONNECT: the network thread sees a
+    // lost connection and keeps running, and the broker publishes our LWT as for a real drop.
+    LOG_WARN("Fault injection: dropping broker connection");
+    if (::shutdown(fd, SHUT_RDWR) != 0) {
+        LOG_WARN(std::string("Fault injection: shutdown failed: ") + std::strerror(errno));
+    }
+}
+
 void MqttClient::stop() noexcept {
     if (stopping_.exchange(true, std::memory_order_relaxed)) return;
     if (!mosq_) return;
@@ -214,3 +271,92 @@ void MqttClient::publish_status_(const std::string& payload) {
         LOG_DEBUG(std::string("status publish failed: ") + mosquitto_strerror(rc));
     }
 }
+
+// subscriptions
+void MqttClient::subscribe(std::string topic, MessageHandler handler) {
+    subscriptions_.push_back(Subscription{std::move(topic), std::move(handler)});
+}
+
+void MqttClient::subscribe_all_() {
+    for (const auto& sub : subscriptions_) {
+        int rc = mosquitto_subscribe(mosq_, nullptr, sub.topic.c_str(), qos_);
+        if (rc != MOSQ_ERR_SUCCESS) {
+            LOG_WARN("subscribe " + sub.topic + " failed: " + mosquitto_strerror(rc));
+        }
+    }
+}
+
+// TLS / reconnect cost
+void MqttClient::mark_connect_started_() {
+    connect_started_ns_.store(std::chrono::steady_clock::now().time_since_epoch() / std::chrono::nanoseconds(1),
+                              std::memory_order_relaxed);
+}
+
+bool MqttClient::configure_tls(const MqttTlsOptions& opts) {
+    if (!mosq_) return false;
+
+    const auto c_str_or_null = [](const std::string& s) { return s.empty() ? nullptr : s.c_str(); };
+
+#if defined(TELEMETRY_HAVE_OPENSSL)
+    if (opts.session_resumption) {
+        // libmosquitto applies the CA/cert/ALPN settings below on top of our context
+        tls_sessions_ = std::make_unique<TlsSessionCache>();
+        int rc = mosquitto_int_option(mosq_, MOSQ_OPT_SSL_CTX_WITH_DEFAULTS, 1);
+        if (rc == MOSQ_ERR_SUCCESS) rc = mosquitto_void_option(mosq_, MOSQ_OPT_SSL_CTX, tls_sessions_->ctx());
+        if (rc != MOSQ_ERR_SUCCESS) {
+            LOG_WARN(std::string("TLS session resumption unavailable: ") + mosquitto_strerror(rc));
+            tls_sessions_.reset();
+        }
+    }
+#else
+    if (opts.session_resumption) LOG_WARN("Built without OpenSSL headers: TLS session resumption disabled");
+#endif
+
+    int rc = mosquitto_tls_set(mosq_,
+                               c_str_or_null(opts.ca_file),
+                               nullptr,
+                               c_str_or_null(opts.cert_file),
+                               c_str_or_null(opts.key_file),
+                               nullptr);
+    if (rc != MOSQ_ERR_SUCCESS) {
+        LOG_ERROR(std::string("mosquitto_tls_set failed: ") + mosquitto_strerror(rc));
+        return false;
+    }
+
+    rc = mosquitto_tls_opts_set(mosq_, /*SSL_VERIFY_PEER*/ 1, c_str_or_null(opts.tls_version), nullptr);
+    if (rc != MOSQ_ERR_SUCCESS) {
+        LOG_ERROR(std::string("mosquitto_tls_opts_set failed: ") + mosquitto_strerror(rc));
+        return false;
+    }
+
+    if (!opts.alpn.empty()) {
+        rc = mosquitto_string_option(mosq_, MOSQ_OPT_TLS_ALPN, opts.alpn.c_str());
+        if (rc != MOSQ_ERR_SUCCESS) {
+            LOG_ERROR(std::string("TLS ALPN option failed: ") + mosquitto_strerror(rc));
+            return false;
+        }
+    }
+
+    if (opts.insecure) {
+        LOG_WARN("TLS hostname verification disabled (insecure)");
+        (void)mosquitto_tls_insecure_set(mosq_, true);
+    }
+
+    tls_enabled_ = true;
+    return true;
+}
+
+TlsStats MqttClient::tls_stats() const {
+    TlsStats stats;
+    stats.enabled = tls_enabled_;
+#if defined(TELEMETRY_HAVE_OPENSSL)
+    if (tls_sessions_) {
+        stats.resumption = true;
+        stats.handshakes = tls_sessions_->handshakes();
+        stats.resumed = tls_sessions_->resumed();
+        stats.last_handshake_us = tls_sessions_->last_handshake_us();
+        stats.total_handshake_us = tls_sessions_->total_handshake_us();
+    }
+#endif
+    return stats;
+}
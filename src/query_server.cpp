@@ -0,0 +1,214 @@
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <nlohmann/json.hpp>
+
+#include "query_server.h"
+#include "time_series_store.h"
+#include "logger.h"
+
+namespace {
+
+    constexpr int kPollMs = 200;
+    constexpr std::size_t kMaxLine = 4096;
+
+} // namespace
+
+QueryServer::QueryServer(const TimeSeriesStore& store, std::string socket_path)
+    : store_(store), socket_path_(std::move(socket_path)) {}
+
+QueryServer::~QueryServer() { stop(); }
+
+bool QueryServer::start() {
+    sockaddr_un addr {};
+    if (socket_path_.empty() || socket_path_.size() >= sizeof(addr.sun_path)) {
+        LOG_ERROR("Invalid query socket path: " + socket_path_);
+        return false;
+    }
+
+    listen_fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0) {
+        LOG_ERROR(std::string("query socket() failed: ") + std::strerror(errno));
+        return false;
+    }
+
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, socket_path_.c_str(), socket_path_.size());
+    ::unlink(socket_path_.c_str()); // stale socket from a previous run
+
+    if (::bind(listen_fd_, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::listen(listen_fd_, 8) != 0) {
+        LOG_ERROR("query socket bind/listen failed on " + socket_path_ + ": " + std::strerror(errno));
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+
+    thread_ = std::thread([this] { serve_(); });
+    LOG_INFO("Query socket listening on " + socket_path_);
+    return true;
+}
+
+void QueryServer::stop() noexcept {
+    if (stopping_.exchange(true, std::memory_order_relaxed)) return;
+    if (thread_.joinable()) thread_.join();
+    if (listen_fd_ >= 0) {
+        ::close(listen_fd_);
+        ::unlink(socket_path_.c_str());
+        listen_fd_ = -1;
+    }
+}
+
+void QueryServer::serve_() {
+    std::vector<Client> clients;
+    std::vector<pollfd> fds;
+
+    while (!stopping_.load(std::memory_order_relaxed)) {
+        fds.clear();
+        fds.push_back(pollfd {listen_fd_, POLLIN, 0});
+        for (const auto& client : clients) {
+            // finish sending a response before reading the next request
+            fds.push_back(pollfd {client.fd, static_cast<short>(client.out.empty() ? POLLIN : POLLOUT), 0});
+        }
+
+        if (::poll(fds.data(), fds.size(), kPollMs) < 0 && errno != EINTR) {
+            LOG_ERROR(std::string("query socket poll failed: ") + std::strerror(errno));
+            break;
+        }
+
+        const auto now = Clock::now();
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < clients.size(); ++i) {
+            auto& client = clients[i];
+            const short revents = fds[i + 1].revents;
+
+            bool keep = now < client.deadline;
+            if (keep && (revents & (POLLERR | POLLNVAL))) keep = false;
+            else if (keep && (revents & POLLOUT)) keep = flush_(client);
+            else if (keep && (revents & (POLLIN | POLLHUP))) keep = read_(client);
+
+            if (!keep) {
+                ::close(client.fd);
+                continue;
+            }
+            if (kept != i) clients[kept] = std::move(client);
+            ++kept;
+        }
+        clients.resize(kept);
+
+        if (fds[0].revents & POLLIN) accept_(clients);
+    }
+
+    for (const auto& client : clients) ::close(client.fd);
+}
+
+void QueryServer::accept_(std::vector<Client>& clients) {
+    const int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK);
+    if (fd < 0) return;
+
+    if (clients.size() >= kMaxClients) {
+        LOG_DEBUG("query socket: too many clients, closing new connection");
+        ::close(fd);
+        return;
+    }
+    clients.push_back(Client {fd, {}, {}, Clock::now() + kRequestTimeout, false});
+}
+
+bool QueryServer::read_(Client& client) {
+    char chunk[1024];
+    for (;;) {
+        const ssize_t n = ::recv(client.fd, chunk, sizeof(chunk), 0);
+        if (n == 0) {
+            // still answer what was sent before the client shut down its side (echo ... | socat)
+            client.eof = true;
+            break;
+        }
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            return false;
+        }
+        client.in.append(chunk, static_cast<std::size_t>(n));
+        if (client.in.size() > kMaxLine && client.in.find('\n') == std::string::npos) return false;
+    }
+
+    std::size_t nl;
+    while ((nl = client.in.find('\n')) != std::string::npos) {
+        client.out += handle_request_(client.in.substr(0, nl));
+        client.out += '\n';
+        client.in.erase(0, nl + 1);
+        // the timeout covers each request, not the whole connection
+        client.deadline = Clock::now() + kRequestTimeout;
+    }
+    return flush_(client);
+}
+
+bool QueryServer::flush_(Client& client) {
+    while (!client.out.empty()) {
+        const ssize_t n = ::send(client.fd, client.out.data(), client.out.size(), MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        client.out.erase(0, static_cast<std::size_t>(n));
+        client.deadline = Clock::now() + kRequestTimeout;
+    }
+    return !client.eof;
+}
+
+std::string QueryServer::handle_request_(const std::string& line) {
+    const auto t0 = std::chrono::steady_clock::now();
+    nlohmann::json resp;
+
+    try {
+        const auto req = nlohmann::json::parse(line);
+        const std::string op = req.value("op", "");
+        const std::string metric = req.value("metric", "");
+        const std::int64_t from_ms = req.value("from_ms", std::numeric_limits<std::int64_t>::min());
+        const std::int64_t to_ms = req.value("to_ms", std::numeric_limits<std::int64_t>::max());
+
+        if (op == "metrics") {
+            resp["metrics"] = store_.metrics();
+        } else if (op == "latest") {
+            const auto point = store_.latest(metric);
+            if (!point) resp["error"] = "unknown metric or no data";
+            else resp = {{"metric", metric}, {"t_ms", point->t_ms}, {"value", point->value}};
+        } else if (op == "range") {
+            std::vector<SeriesPoint> points;
+            if (!store_.range(metric, from_ms, to_ms, points)) {
+                resp["error"] = "unknown metric";
+            } else {
+                resp["metric"] = metric;
+                resp["points"] = nlohmann::json::array();
+                for (const auto& p : points) resp["points"].push_back({p.t_ms, p.value});
+            }
+        } else if (op == "downsample") {
+            std::vector<SeriesBucket> buckets;
+            const std::int64_t step_ms = req.value("step_ms", std::int64_t{60000});
+            if (!store_.downsample(metric, from_ms, to_ms, step_ms, buckets)) {
+                resp["error"] = "unknown metric or invalid step_ms";
+            } else {
+                resp["metric"] = metric;
+                resp["step_ms"] = step_ms;
+                resp["buckets"] = nlohmann::json::array();
+                for (const auto& b : buckets) resp["buckets"].push_back({b.t_ms, b.min, b.max, b.avg, b.count});
+            }
+        } else {
+            resp["error"] = "unknown op: " + op;
+        }
+    } catch (const std::exception& e) {
+        resp = {{"error", std::string("bad request: ") + e.what()}};
+    }
+
+    const auto t1 = std::chrono::steady_clock::now();
+    queries_.fetch_add(1, std::memory_order_relaxed);
+    query_ns_.fetch_add((std::uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count(),
+                        std::memory_order_relaxed);
+    return resp.dump();
+}
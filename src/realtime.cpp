@@ -0,0 +1,133 @@
+#include <alloca.h>
+#include <cerrno>
+#include <cstring>
+#include <malloc.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include "realtime.h"
+#include "logger.h"
+
+namespace {
+
+    // Touch each page of `bytes` of stack below the caller's frame so it is resident before the
+    // loop starts. One alloca'd block rather than recursion: a recursive version compiles to a
+    // tail call that reuses a single frame and only ever touches the first chunk.
+    __attribute__((noinline)) void prefault_stack(std::size_t bytes) {
+        const long page = sysconf(_SC_PAGESIZE);
+        const std::size_t step = page > 0 ? static_cast<std::size_t>(page) : 4096;
+
+        auto* block = static_cast<volatile unsigned char*>(alloca(bytes));
+        // top-down, in the direction the stack grows
+        for (std::size_t i = bytes; i >= step; i -= step) block[i - 1] = 0;
+        block[0] = 0;
+    }
+
+} // namespace
+
+bool set_thread_affinity(const std::vector<int>& cpus) {
+    if (cpus.empty()) return true;
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (const int cpu : cpus) {
+        if (cpu < 0 || cpu >= CPU_SETSIZE) {
+            LOG_WARN("Ignoring invalid cpu index: " + std::to_string(cpu));
+            continue;
+        }
+        CPU_SET(cpu, &set);
+    }
+
+    const int rc = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (rc != 0) {
+        LOG_WARN(std::string("pthread_setaffinity_np failed: ") + std::strerror(rc));
+        return false;
+    }
+    return true;
+}
+
+std::vector<int> get_thread_affinity() {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    const int rc = pthread_getaffinity_np(pthread_self(), sizeof(set), &set);
+    if (rc != 0) {
+        LOG_WARN(std::string("pthread_getaffinity_np failed: ") + std::strerror(rc));
+        return {};
+    }
+
+    std::vector<int> cpus;
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+bool set_thread_scheduling(const std::string& policy, int priority) {
+    sched_param param {};
+    int native = SCHED_OTHER;
+
+    if (policy == "fifo") native = SCHED_FIFO;
+    else if (policy == "rr") native = SCHED_RR;
+
+    if (native != SCHED_OTHER) param.sched_priority = priority;
+
+    const int rc = pthread_setschedparam(pthread_self(), native, &param);
+    if (rc != 0) {
+        LOG_WARN("pthread_setschedparam(" + policy + ", " + std::to_string(priority) + ") failed: " +
+                 std::strerror(rc) + " (needs CAP_SYS_NICE or LimitRTPRIO)");
+        return false;
+    }
+    return true;
+}
+
+bool set_default_thread_stack(std::size_t kb) {
+    pthread_attr_t attr;
+    int rc = pthread_attr_init(&attr);
+    if (rc == 0) rc = pthread_attr_setstacksize(&attr, kb * 1024);
+    if (rc == 0) rc = pthread_setattr_default_np(&attr);
+    pthread_attr_destroy(&attr);
+    if (rc != 0) {
+        LOG_WARN("Setting the default thread stack to " + std::to_string(kb) + " KiB failed: " + std::strerror(rc));
+        return false;
+    }
+    return true;
+}
+
+bool lock_and_prefault_memory(std::size_t heap_kb, std::size_t stack_kb) {
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        LOG_WARN(std::string("mlockall failed: ") + std::strerror(errno) + " (needs CAP_IPC_LOCK or LimitMEMLOCK)");
+        return false;
+    }
+
+    // keep freed memory in the heap instead of returning it to the kernel
+    mallopt(M_TRIM_THRESHOLD, -1);
+    mallopt(M_MMAP_MAX, 0);
+
+    if (heap_kb > 0) {
+        const std::size_t bytes = heap_kb * 1024;
+        auto* heap = static_cast<unsigned char*>(malloc(bytes));
+        if (heap) {
+            std::memset(heap, 0, bytes);
+            free(heap);
+        }
+    }
+
+    if (stack_kb > 0) {
+        // leave room under RLIMIT_STACK for the frames already in use
+        constexpr std::size_t kHeadroomKb = 256;
+        rlimit limit {};
+        if (getrlimit(RLIMIT_STACK, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY) {
+            const std::size_t max_kb = limit.rlim_cur / 1024 > kHeadroomKb ? limit.rlim_cur / 1024 - kHeadroomKb : 0;
+            if (stack_kb > max_kb) {
+                LOG_WARN("prefault_stack_kb " + std::to_string(stack_kb) + " exceeds the stack limit, prefaulting " +
+                         std::to_string(max_kb) + " KiB");
+                stack_kb = max_kb;
+            }
+        }
+        if (stack_kb > 0) prefault_stack(stack_kb * 1024);
+    }
+    return true;
+}
@@ -0,0 +1,234 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <filesystem>
+#include <stdexcept>
+#include <unistd.h>
+
+#include "app_config.h"
+#include "recorder.h"
+#include "logger.h"
+
+namespace {
+
+    // records queued between two writer passes; at 16 bytes each this is 256 KiB per buffer
+    constexpr std::size_t kQueueCapacity = 16384;
+    constexpr auto kWriteEvery = std::chrono::milliseconds(500);
+
+    // metric names are free-form in the config; keep them inside the directory
+    std::string file_stem(const std::string& metric) {
+        std::string out = metric;
+        for (auto& c : out) {
+            const bool ok = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+                            c == '_' || c == '-' || c == '.';
+            if (!ok) c = '_';
+        }
+        if (out.empty() || out[0] == '.') out.insert(out.begin(), '_'); // no hidden files, "." or ".."
+        return out;
+    }
+
+    // "-yyyymmddThhmmssZ-nnn.rec" after the stem; sorts by creation time within one stem
+    bool is_recording_of(const std::string& file_name, const std::string& stem) {
+        if (file_name.size() != stem.size() + 25 || file_name.compare(0, stem.size(), stem) != 0) return false;
+        const std::string rest = file_name.substr(stem.size());
+        return rest[0] == '-' && rest[9] == 'T' && rest[16] == 'Z' && rest[17] == '-' && rest.compare(21, 4, ".rec") == 0;
+    }
+
+    std::string utc_stamp() {
+        const std::time_t now = std::time(nullptr);
+        std::tm tm {};
+        gmtime_r(&now, &tm);
+        char buf[20];
+        std::strftime(buf, sizeof(buf), "%Y%m%dT%H%M%SZ", &tm);
+        return buf;
+    }
+
+} // namespace
+
+Recorder::Recorder(const RecordConfig& cfg, const std::vector<MetricConfig>& metrics)
+    : directory_(cfg.directory),
+      max_file_bytes_(static_cast<std::uint64_t>(cfg.max_file_kb) * 1024),
+      max_files_(cfg.max_files) {
+    outputs_.resize(metrics.size());
+
+    const auto close_all = [this]() {
+        for (auto& out : outputs_) close_(out);
+    };
+
+    for (std::size_t i = 0; i < metrics.size(); ++i) {
+        if (metrics[i].type == "waveform") continue;
+
+        const std::string stem = file_stem(metrics[i].name);
+        for (const auto& other : outputs_) {
+            if (other.stem != stem) continue;
+            close_all();
+            throw std::runtime_error("Recordings " + directory_ + "/" + stem + "-*.rec would be shared by two metrics; rename one of them");
+        }
+        outputs_[i].stem = stem;
+
+        try {
+            open_(outputs_[i]);
+        } catch (...) {
+            close_all();
+            throw;
+        }
+        LOG_INFO("Recording " + metrics[i].name + " to " + directory_ + "/" + stem + "-*.rec");
+    }
+
+    queue_.reserve(kQueueCapacity);
+    batch_.reserve(kQueueCapacity);
+    writer_ = std::thread([this]() { run_(); });
+}
+
+Recorder::~Recorder() {
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        stop_ = true;
+    }
+    cv_.notify_one();
+    if (writer_.joinable()) writer_.join();
+    for (auto& out : outputs_) close_(out);
+}
+
+void Recorder::append(std::size_t metric_idx, std::chrono::steady_clock::time_point now, double value) {
+    if (metric_idx >= outputs_.size() || outputs_[metric_idx].stem.empty()) return;
+
+    const replay_format::Record rec {
+        std::chrono::duration_cast<std::chrono::microseconds>(now - start_).count(),
+        value
+    };
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (queue_.size() == queue_.capacity()) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    queue_.push_back(Pending {metric_idx, rec});
+}
+
+void Recorder::flush() {
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        wake_ = true;
+    }
+    cv_.notify_one();
+}
+
+void Recorder::open_(Output& out) {
+    const std::string name_prefix = out.stem + "-" + utc_stamp() + "-";
+    const std::string prefix = directory_ + "/" + name_prefix;
+
+    // several files can start within one second (restarts, small max_file_kb); number them after
+    // every file already there, even pruned gaps, so names keep sorting oldest first
+    int first = 0;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(directory_, ec)) {
+        const std::string name = entry.path().filename().string();
+        if (!is_recording_of(name, out.stem) || name.compare(0, name_prefix.size(), name_prefix) != 0) continue;
+        first = std::max(first, std::atoi(name.c_str() + name_prefix.size()) + 1);
+    }
+
+    for (int n = first; n < 1000; ++n) {
+        char seq[12];
+        std::snprintf(seq, sizeof(seq), "%03d", n);
+        const std::string path = prefix + seq + ".rec";
+
+        const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+        if (fd < 0 && errno == EEXIST) continue;
+        std::FILE* file = fd >= 0 ? fdopen(fd, "wb") : nullptr;
+        if (!file) {
+            const int err = errno;
+            if (fd >= 0) ::close(fd);
+            throw std::runtime_error("Failed to open recording " + path + ": " + std::strerror(err));
+        }
+
+        replay_format::Header header {};
+        std::memcpy(header.magic, replay_format::kMagic, sizeof(header.magic));
+        header.version = replay_format::kVersion;
+        header.record_size = sizeof(replay_format::Record);
+        std::fwrite(&header, sizeof(header), 1, file);
+
+        out.file = file;
+        out.bytes = sizeof(header);
+        prune_(out);
+        return;
+    }
+    throw std::runtime_error("Failed to open recording " + prefix + "nnn.rec: too many files this second");
+}
+
+void Recorder::close_(Output& out) {
+    if (out.file) std::fclose(out.file);
+    out.file = nullptr;
+}
+
+void Recorder::prune_(const Output& out) const {
+    if (max_files_ <= 0) return;
+
+    std::error_code ec;
+    std::vector<std::string> names;
+    for (const auto& entry : std::filesystem::directory_iterator(directory_, ec)) {
+        const std::string name = entry.path().filename().string();
+        if (is_recording_of(name, out.stem)) names.push_back(name);
+    }
+    if (names.size() <= static_cast<std::size_t>(max_files_)) return;
+
+    // unlinking a file a ReplaySensor has mapped is safe; the mapping keeps its pages
+    std::sort(names.begin(), names.end());
+    for (std::size_t i = 0; i + static_cast<std::size_t>(max_files_) < names.size(); ++i) {
+        if (std::remove((directory_ + "/" + names[i]).c_str()) != 0) {
+            LOG_WARN("Failed to remove old recording " + directory_ + "/" + names[i] + ": " + std::strerror(errno));
+        }
+    }
+}
+
+void Recorder::write_(const std::vector<Pending>& batch) {
+    // reopen after a failed rotation, at most once per pass
+    for (auto& out : outputs_) {
+        if (out.stem.empty() || out.file) continue;
+        try {
+            open_(out);
+        } catch (const std::exception& e) {
+            LOG_ERROR(e.what());
+        }
+    }
+
+    for (const auto& p : batch) {
+        auto& out = outputs_[p.metric_idx];
+        if (!out.file || std::fwrite(&p.rec, sizeof(p.rec), 1, out.file) != 1) {
+            write_errors_.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        out.bytes += sizeof(p.rec);
+        if (out.bytes < max_file_bytes_) continue;
+
+        close_(out);
+        try {
+            open_(out);
+        } catch (const std::exception& e) {
+            LOG_ERROR(e.what());
+        }
+    }
+
+    for (auto& out : outputs_) {
+        if (out.file) std::fflush(out.file);
+    }
+}
+
+void Recorder::run_() {
+    std::unique_lock<std::mutex> lock(mtx_);
+    for (;;) {
+        cv_.wait_for(lock, kWriteEvery, [this]() { return wake_ || stop_; });
+        wake_ = false;
+        const bool stopping = stop_;
+        batch_.swap(queue_);
+        lock.unlock();
+
+        write_(batch_);
+        batch_.clear();
+
+        lock.lock();
+        if (stopping) return;
+    }
+}
@@ -0,0 +1,94 @@
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "replay_sensor.h"
+#include "logger.h"
+
+ReplaySensor::ReplaySensor(std::string metric, std::string unit, std::string path, double speed, bool loop)
+    : metric_(std::move(metric)), unit_(std::move(unit)), path_(std::move(path)), speed_(speed), loop_(loop) {}
+
+ReplaySensor::~ReplaySensor() {
+    if (map_) munmap(map_, map_len_);
+}
+
+bool ReplaySensor::init() {
+    const int fd = ::open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        LOG_ERROR("Failed to open replay file " + path_ + ": " + std::strerror(errno));
+        return false;
+    }
+
+    struct stat st {};
+    if (fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(replay_format::Header)) {
+        LOG_ERROR("Replay file too small: " + path_);
+        ::close(fd);
+        return false;
+    }
+
+    map_len_ = static_cast<std::size_t>(st.st_size);
+    map_ = mmap(nullptr, map_len_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map_ == MAP_FAILED) {
+        map_ = nullptr;
+        LOG_ERROR("mmap failed for " + path_ + ": " + std::strerror(errno));
+        return false;
+    }
+    (void)madvise(map_, map_len_, MADV_SEQUENTIAL);
+
+    const auto* header = static_cast<const replay_format::Header*>(map_);
+    if (std::memcmp(header->magic, replay_format::kMagic, sizeof(header->magic)) != 0 ||
+        header->version != replay_format::kVersion ||
+        header->record_size != sizeof(replay_format::Record)) {
+        LOG_ERROR("Not a replay file (bad header): " + path_);
+        return false;
+    }
+
+    records_ = reinterpret_cast<const replay_format::Record*>(static_cast<const char*>(map_) + sizeof(replay_format::Header));
+    count_ = (map_len_ - sizeof(replay_format::Header)) / sizeof(replay_format::Record);
+    if (count_ == 0) {
+        LOG_ERROR("Replay file has no records: " + path_);
+        return false;
+    }
+
+    LOG_INFO("Replaying " + std::to_string(count_) + " records for " + metric_ + " from " + path_);
+    return true;
+}
+
+std::optional<Reading> ReplaySensor::sample() {
+    if (!records_) return std::nullopt;
+
+    if (next_ >= count_) {
+        if (!loop_) return std::nullopt;
+        next_ = 0;
+        play_start_ = {};
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    if (play_start_.time_since_epoch().count() == 0) play_start_ = now;
+
+    if (speed_ > 0.0) {
+        playhead_us_ = std::chrono::duration<double, std::micro>(now - play_start_).count() * speed_;
+        if (!due_(next_)) return std::nullopt;
+    }
+
+    return Reading {
+        .metric_name = metric_,
+        .unit = unit_,
+        .value = records_[next_++].value
+    };
+}
+
+bool ReplaySensor::has_pending() const {
+    // a wrap-around restarts the clock on the next sample(), so at most one pass per loop iteration
+    return records_ && speed_ > 0.0 && next_ < count_ && due_(next_);
+}
+
+bool ReplaySensor::due_(std::size_t idx) const {
+    return static_cast<double>(records_[idx].t_us - records_[0].t_us) <= playhead_us_;
+}
+
+std::string_view ReplaySensor::name() const { return metric_; }
@@ -0,0 +1,148 @@
+#include <stdexcept>
+
+#include "rule_engine.h"
+#include "app_config.h"
+
+namespace {
+
+    std::size_t metric_index_or_throw(const std::vector<MetricConfig>& metrics, const std::string& name) {
+        for (std::size_t i = 0; i < metrics.size(); ++i) {
+            if (metrics[i].name == name) return i;
+        }
+        throw std::runtime_error("rule references unknown metric: " + name);
+    }
+
+    bool outside(double value, double low, double high) noexcept {
+        return value < low || value > high;
+    }
+
+} // namespace
+
+RuleEngine::RuleEngine(const std::vector<RuleConfig>& rules, const std::vector<MetricConfig>& metrics)
+    : by_metric_(metrics.size()), latest_(metrics.size(), 0.0), has_latest_(metrics.size(), false) {
+
+    rules_.reserve(rules.size());
+
+    for (const auto& rule : rules) {
+        CompiledRule compiled;
+        compiled.name = rule.name;
+        compiled.metric_name = rule.metric;
+        compiled.kind = rule.kind == "rate" ? Kind::Rate : rule.kind == "band" ? Kind::Band : Kind::Threshold;
+
+        if (rule.op == ">=") compiled.op = Op::Ge;
+        else if (rule.op == "<") compiled.op = Op::Lt;
+        else if (rule.op == "<=") compiled.op = Op::Le;
+        else compiled.op = Op::Gt;
+
+        compiled.value = rule.value;
+        compiled.metric = metric_index_or_throw(metrics, rule.metric);
+        compiled.low = rule.low;
+        compiled.high = rule.high;
+
+        if (!rule.with_metric.empty()) {
+            compiled.has_with = true;
+            compiled.with_metric_name = rule.with_metric;
+            compiled.with_metric = metric_index_or_throw(metrics, rule.with_metric);
+            compiled.with_low = rule.with_low;
+            compiled.with_high = rule.with_high;
+        }
+
+        compiled.hold = std::chrono::milliseconds(rule.for_ms);
+
+        const std::size_t idx = rules_.size();
+        by_metric_[compiled.metric].push_back(idx);
+        if (compiled.has_with && compiled.with_metric != compiled.metric) {
+            by_metric_[compiled.with_metric].push_back(idx);
+        }
+        rules_.push_back(std::move(compiled));
+    }
+}
+
+bool RuleEngine::compare_(Op op, double lhs, double rhs) noexcept {
+    switch (op) {
+        case Op::Gt: return lhs > rhs;
+        case Op::Ge: return lhs >= rhs;
+        case Op::Lt: return lhs < rhs;
+        case Op::Le: return lhs <= rhs;
+    }
+    return false;
+}
+
+bool RuleEngine::condition_(CompiledRule& rule, std::size_t metric_idx, double value, Clock::time_point now) {
+    switch (rule.kind) {
+        case Kind::Threshold:
+            return compare_(rule.op, value, rule.value);
+
+        case Kind::Rate: {
+            // rate is units per second between consecutive samples of the rule's metric
+            const bool had_prev = rule.has_prev;
+            const double prev_value = rule.prev_value;
+            const auto prev_time = rule.prev_time;
+            rule.has_prev = true;
+            rule.prev_value = value;
+            rule.prev_time = now;
+
+            if (!had_prev) return false;
+            const double dt_s = std::chrono::duration<double>(now - prev_time).count();
+            if (dt_s <= 0.0) return false;
+            return compare_(rule.op, (value - prev_value) / dt_s, rule.value);
+        }
+
+        case Kind::Band: {
+            if (!has_latest_[rule.metric]) return false;
+            const double primary = metric_idx == rule.metric ? value : latest_[rule.metric];
+            if (!outside(primary, rule.low, rule.high)) return false;
+            if (!rule.has_with) return true;
+
+            if (!has_latest_[rule.with_metric]) return false;
+            const double secondary = metric_idx == rule.with_metric ? value : latest_[rule.with_metric];
+            return outside(secondary, rule.with_low, rule.with_high);
+        }
+    }
+    return false;
+}
+
+RuleEvent RuleEngine::make_event_(const CompiledRule& rule, std::string_view state) const noexcept {
+    // band rules can be triggered by their second metric, so report the stored values, not the sample
+    RuleEvent event {rule.name, rule.metric_name, state, latest_[rule.metric], {}, 0.0};
+    if (rule.has_with) {
+        event.with_metric = rule.with_metric_name;
+        event.with_value = latest_[rule.with_metric];
+    }
+    return event;
+}
+
+std::size_t RuleEngine::evaluate(std::size_t metric_idx, double value, Clock::time_point now, std::vector<RuleEvent>& out) {
+    if (metric_idx >= by_metric_.size()) return 0;
+
+    latest_[metric_idx] = value;
+    has_latest_[metric_idx] = true;
+
+    std::size_t emitted = 0;
+
+    for (const std::size_t idx : by_metric_[metric_idx]) {
+        auto& rule = rules_[idx];
+
+        // rate rules only advance on their own metric
+        if (rule.kind == Kind::Rate && metric_idx != rule.metric) continue;
+
+        if (condition_(rule, metric_idx, value, now)) {
+            if (rule.pending_since.time_since_epoch().count() == 0) rule.pending_since = now;
+
+            if (!rule.active && now - rule.pending_since >= rule.hold) {
+                rule.active = true;
+                out.push_back(make_event_(rule, "fired"));
+                ++emitted;
+            }
+        } else {
+            rule.pending_since = {};
+
+            if (rule.active) {
+                rule.active = false;
+                out.push_back(make_event_(rule, "cleared"));
+                ++emitted;
+            }
+        }
+    }
+    return emitted;
+}
@@ -2,6 +2,7 @@
 
 #include "app_config.h"
 #include "simulated_sensor.h"
+#include "replay_sensor.h"
 #include "sensor.h"
 #include "logger.h"
 
@@ -10,6 +11,10 @@ std::unique_ptr<ISensor> make_sensor(const MetricConfig& metric) {
         return std::make_unique<SimulatedSensor>(metric.name, metric.unit, metric.start, metric.step);
     }
 
+    if (metric.type == "replay") {
+        return std::make_unique<ReplaySensor>(metric.name, metric.unit, metric.file, metric.speed, metric.loop);
+    }
+
     // Future: if (metric.type == "device_name") return std::make_unique<deviceSensor>(...)
 
     LOG_WARN("Unkown sensor type: " + metric.type + " (falling back to simulated)");
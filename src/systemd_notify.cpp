@@ -0,0 +1,86 @@
+#include <cerrno>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "systemd_notify.h"
+#include "logger.h"
+
+SystemdNotifier::SystemdNotifier() {
+    const char* socket_path = std::getenv("NOTIFY_SOCKET");
+    if (!socket_path || socket_path[0] == '\0') return;
+
+    const std::size_t len = std::strlen(socket_path);
+    // must be absolute path or abstract namespace ('@' prefix)
+    if ((socket_path[0] != '/' && socket_path[0] != '@') || len >= sizeof(addr_.sun_path)) {
+        LOG_WARN(std::string("Ignoring invalid NOTIFY_SOCKET: ") + socket_path);
+        return;
+    }
+
+    addr_.sun_family = AF_UNIX;
+    std::memcpy(addr_.sun_path, socket_path, len);
+    if (addr_.sun_path[0] == '@') addr_.sun_path[0] = '\0';
+    addr_len_ = static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) + len);
+
+    fd_ = ::socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (fd_ < 0) {
+        LOG_WARN(std::string("notify socket() failed: ") + std::strerror(errno));
+        return;
+    }
+
+    const char* watchdog_usec = std::getenv("WATCHDOG_USEC");
+    const char* watchdog_pid = std::getenv("WATCHDOG_PID");
+    const bool for_us = !watchdog_pid || std::strtol(watchdog_pid, nullptr, 10) == static_cast<long>(getpid());
+
+    if (watchdog_usec && for_us) {
+        const long long usec = std::strtoll(watchdog_usec, nullptr, 10);
+        // ping at half the timeout, as recommended by sd_watchdog_enabled(3)
+        if (usec > 0) watchdog_interval_ = std::chrono::microseconds(usec / 2);
+    }
+
+    LOG_INFO(std::string("systemd notify enabled (watchdog ") + (watchdog_interval_.count() > 0 ? "on" : "off") + ")");
+}
+
+SystemdNotifier::~SystemdNotifier() {
+    if (fd_ >= 0) ::close(fd_);
+}
+
+bool SystemdNotifier::notify(std::string_view state) {
+    if (fd_ < 0) return false;
+
+    const ssize_t n = ::sendto(fd_, state.data(), state.size(), MSG_NOSIGNAL,
+                               reinterpret_cast<const sockaddr*>(&addr_), addr_len_);
+    if (n < 0) {
+        LOG_DEBUG(std::string("sd_notify send failed: ") + std::strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+void SystemdNotifier::ready() {
+    if (ready_sent_) return;
+    if (notify("READY=1")) ready_sent_ = true;
+}
+
+void SystemdNotifier::status(std::string_view text) {
+    if (fd_ < 0) return;
+    std::string msg = "STATUS=";
+    msg.append(text);
+    (void)notify(msg);
+}
+
+void SystemdNotifier::stopping() {
+    (void)notify("STOPPING=1");
+}
+
+void SystemdNotifier::watchdog(Clock::time_point now) {
+    if (!watchdog_enabled()) return;
+    if (now < next_watchdog_) return;
+
+    (void)notify("WATCHDOG=1");
+    next_watchdog_ = now + watchdog_interval_;
+}
@@ -0,0 +1,133 @@
+#include <algorithm>
+#include <limits>
+
+#include "time_series_store.h"
+
+TimeSeriesStore::TimeSeriesStore(const std::vector<std::string>& metric_names,
+                                 std::chrono::hours retention,
+                                 std::chrono::milliseconds chunk_span)
+    : retention_ms_(std::chrono::duration_cast<std::chrono::milliseconds>(retention).count()),
+      chunk_span_ms_(std::max<std::int64_t>(1, chunk_span.count())) {
+
+    series_.reserve(metric_names.size());
+    for (const auto& name : metric_names) {
+        auto series = std::make_unique<Series>();
+        series->name = name;
+        series_.push_back(std::move(series));
+    }
+}
+
+void TimeSeriesStore::append(std::size_t metric_idx, std::int64_t t_ms, double value) {
+    if (metric_idx >= series_.size()) return;
+    auto& series = *series_[metric_idx];
+
+    std::lock_guard<std::mutex> lock(series.mtx);
+
+    // keep each series sorted even if the wall clock steps backwards
+    if (series.latest && t_ms < series.latest->t_ms) t_ms = series.latest->t_ms;
+
+    if (series.chunks.empty() || t_ms >= series.chunks.back().start_ms() + chunk_span_ms_) {
+        series.chunks.emplace_back(t_ms);
+    }
+    series.chunks.back().append(t_ms, value);
+    series.latest = SeriesPoint{t_ms, value};
+
+    while (series.chunks.size() > 1 && series.chunks.front().last_ms() < t_ms - retention_ms_) {
+        series.chunks.pop_front();
+    }
+}
+
+const TimeSeriesStore::Series* TimeSeriesStore::find_(std::string_view metric) const {
+    for (const auto& series : series_) {
+        if (series->name == metric) return series.get();
+    }
+    return nullptr;
+}
+
+std::optional<SeriesPoint> TimeSeriesStore::latest(std::string_view metric) const {
+    const auto* series = find_(metric);
+    if (!series) return std::nullopt;
+
+    std::lock_guard<std::mutex> lock(series->mtx);
+    return series->latest;
+}
+
+std::vector<GorillaChunk> TimeSeriesStore::snapshot_(const Series& series, std::int64_t from_ms, std::int64_t to_ms) const {
+    std::vector<GorillaChunk> chunks;
+
+    // only the compressed words are copied under the lock; callers decode the copy, so a long
+    // query does not stall append() on the sampling loop
+    std::lock_guard<std::mutex> lock(series.mtx);
+    for (const auto& chunk : series.chunks) {
+        if (chunk.last_ms() < from_ms || chunk.start_ms() > to_ms) continue;
+        chunks.push_back(chunk);
+    }
+    return chunks;
+}
+
+bool TimeSeriesStore::range(std::string_view metric, std::int64_t from_ms, std::int64_t to_ms, std::vector<SeriesPoint>& out) const {
+    const auto* series = find_(metric);
+    if (!series) return false;
+
+    for (const auto& chunk : snapshot_(*series, from_ms, to_ms)) {
+        chunk.for_each([&](std::int64_t t, double v) {
+            if (t >= from_ms && t <= to_ms) out.push_back(SeriesPoint{t, v});
+        });
+    }
+    return true;
+}
+
+bool TimeSeriesStore::downsample(std::string_view metric, std::int64_t from_ms, std::int64_t to_ms, std::int64_t step_ms,
+                                 std::vector<SeriesBucket>& out) const {
+    const auto* series = find_(metric);
+    if (!series || step_ms <= 0) return false;
+
+    SeriesBucket bucket {};
+    double sum = 0.0;
+
+    const auto flush = [&]() {
+        if (bucket.count == 0) return;
+        bucket.avg = sum / static_cast<double>(bucket.count);
+        out.push_back(bucket);
+    };
+
+    for (const auto& chunk : snapshot_(*series, from_ms, to_ms)) {
+        chunk.for_each([&](std::int64_t t, double v) {
+            if (t < from_ms || t > to_ms) return;
+
+            // buckets are aligned to the epoch so results are stable across query windows
+            const std::int64_t rem = t % step_ms;
+            const std::int64_t start = t - (rem < 0 ? rem + step_ms : rem);
+            if (bucket.count == 0 || start != bucket.t_ms) {
+                flush();
+                bucket = SeriesBucket{start, std::numeric_limits<double>::max(), std::numeric_limits<double>::lowest(), 0.0, 0};
+                sum = 0.0;
+            }
+            bucket.min = std::min(bucket.min, v);
+            bucket.max = std::max(bucket.max, v);
+            sum += v;
+            ++bucket.count;
+        });
+    }
+    flush();
+    return true;
+}
+
+std::vector<std::string> TimeSeriesStore::metrics() const {
+    std::vector<std::string> names;
+    names.reserve(series_.size());
+    for (const auto& series : series_) names.push_back(series->name);
+    return names;
+}
+
+TimeSeriesStore::Stats TimeSeriesStore::stats() const {
+    Stats stats;
+    for (const auto& series : series_) {
+        std::lock_guard<std::mutex> lock(series->mtx);
+        for (const auto& chunk : series->chunks) {
+            stats.points += chunk.count();
+            stats.bytes += chunk.bytes();
+        }
+    }
+    return stats;
+}
@@ -0,0 +1,89 @@
+#include <chrono>
+#include <stdexcept>
+
+#include "tls_session.h"
+#include "logger.h"
+
+#if defined(TELEMETRY_HAVE_OPENSSL)
+
+#include <openssl/ssl.h>
+
+namespace {
+
+    int ctx_ex_index() {
+        static const int idx = SSL_CTX_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+        return idx;
+    }
+
+    std::int64_t now_ns() {
+        return std::chrono::steady_clock::now().time_since_epoch() / std::chrono::nanoseconds(1);
+    }
+
+} // namespace
+
+TlsSessionCache::TlsSessionCache() {
+    ctx_ = SSL_CTX_new(TLS_client_method());
+    if (!ctx_) throw std::runtime_error("SSL_CTX_new failed");
+
+    SSL_CTX_set_ex_data(ctx_, ctx_ex_index(), this);
+
+    // client-side caching only reports new sessions via the callback; we store the latest one
+    SSL_CTX_set_session_cache_mode(ctx_, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+    SSL_CTX_sess_set_new_cb(ctx_, &TlsSessionCache::on_new_session_);
+    SSL_CTX_set_info_callback(ctx_, &TlsSessionCache::on_info_);
+}
+
+TlsSessionCache::~TlsSessionCache() {
+    if (session_) SSL_SESSION_free(session_);
+    if (ctx_) SSL_CTX_free(ctx_);
+}
+
+TlsSessionCache* TlsSessionCache::from_(const SSL* ssl) {
+    return static_cast<TlsSessionCache*>(SSL_CTX_get_ex_data(SSL_get_SSL_CTX(ssl), ctx_ex_index()));
+}
+
+int TlsSessionCache::on_new_session_(SSL* ssl, SSL_SESSION* session) {
+    auto* self = from_(ssl);
+    if (!self) return 0;
+
+    std::lock_guard<std::mutex> lock(self->mtx_);
+    if (self->session_) SSL_SESSION_free(self->session_);
+    self->session_ = session;
+    return 1; // we keep the reference
+}
+
+void TlsSessionCache::on_info_(const SSL* ssl, int where, int /*ret*/) {
+    auto* self = from_(ssl);
+    if (!self) return;
+
+    // TLS 1.3 post-handshake messages also raise HANDSHAKE_START/DONE; only track the initial one
+    if ((where & SSL_CB_HANDSHAKE_START) && SSL_in_before(ssl)) {
+        self->started_ns_.store(now_ns(), std::memory_order_relaxed);
+        self->in_handshake_.store(true, std::memory_order_release);
+
+        std::lock_guard<std::mutex> lock(self->mtx_);
+        if (self->session_ && SSL_SESSION_is_resumable(self->session_)) {
+            // ClientHello is not built yet, so the session offered for resumption can still be set
+            SSL_set_session(const_cast<SSL*>(ssl), self->session_);
+        }
+    }
+
+    if ((where & SSL_CB_HANDSHAKE_DONE) && self->in_handshake_.exchange(false, std::memory_order_acquire)) {
+        const auto us = static_cast<std::uint64_t>((now_ns() - self->started_ns_.load(std::memory_order_relaxed)) / 1000);
+        const bool reused = SSL_session_reused(const_cast<SSL*>(ssl)) == 1;
+
+        self->handshakes_.fetch_add(1, std::memory_order_relaxed);
+        if (reused) self->resumed_.fetch_add(1, std::memory_order_relaxed);
+        self->last_us_.store(us, std::memory_order_relaxed);
+        self->total_us_.fetch_add(us, std::memory_order_relaxed);
+
+        LOG_DEBUG(std::string("TLS handshake ") + (reused ? "resumed" : "full") + " in " + std::to_string(us) + " us");
+    }
+}
+
+#else // !TELEMETRY_HAVE_OPENSSL
+
+TlsSessionCache::TlsSessionCache() { throw std::runtime_error("built without OpenSSL"); }
+TlsSessionCache::~TlsSessionCache() = default;
+
+#endif
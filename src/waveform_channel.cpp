@@ -0,0 +1,153 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <numbers>
+#include <random>
+
+#include "waveform_channel.h"
+#include "logger.h"
+
+WaveformChannel::WaveformChannel(std::string metric, std::string unit, WaveformConfig cfg)
+    : metric_(std::move(metric)),
+      unit_(std::move(unit)),
+      cfg_(std::move(cfg)),
+      n_(static_cast<std::size_t>(cfg_.block_size)),
+      fft_(n_),
+      window_(n_),
+      re_(n_),
+      im_(n_),
+      pow_(n_ / 2 + 1) {
+
+    for (auto& buf : bufs_) buf.assign(n_, 0.0f);
+
+    // Hann window
+    for (std::size_t i = 0; i < n_; ++i) {
+        const double w = 0.5 - 0.5 * std::cos(2.0 * std::numbers::pi * static_cast<double>(i) / static_cast<double>(n_));
+        window_[i] = static_cast<float>(w);
+        window_power_ += w * w;
+    }
+
+    const double bin_hz = static_cast<double>(cfg_.sample_rate_hz) / static_cast<double>(n_);
+    for (const auto& [lo, hi] : cfg_.bands) {
+        const auto first = static_cast<std::size_t>(std::ceil(lo / bin_hz));
+        const auto last = std::min(n_ / 2, static_cast<std::size_t>(std::floor(hi / bin_hz)));
+        band_bins_.emplace_back(first, last);
+    }
+
+    snippet_.reserve(static_cast<std::size_t>(cfg_.snippet_len));
+}
+
+WaveformChannel::~WaveformChannel() { stop(); }
+
+bool WaveformChannel::start() {
+    if (running_.exchange(true, std::memory_order_relaxed)) return true;
+    producer_ = std::thread([this] { produce_(); });
+    LOG_INFO("Waveform channel " + metric_ + ": " + std::to_string(cfg_.sample_rate_hz) + " Hz, block " +
+             std::to_string(n_) + ", kernels " + std::string(dsp::isa()));
+    return true;
+}
+
+void WaveformChannel::stop() noexcept {
+    running_.store(false, std::memory_order_relaxed);
+    if (producer_.joinable()) producer_.join();
+}
+
+void WaveformChannel::produce_() {
+    std::minstd_rand rng(0x5eed);
+    std::uniform_real_distribution<float> noise(-1.0f, 1.0f);
+
+    const double phase_step = 2.0 * std::numbers::pi * cfg_.freq_hz / static_cast<double>(cfg_.sample_rate_hz);
+    const auto block_period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(static_cast<double>(n_) / static_cast<double>(cfg_.sample_rate_hz)));
+
+    double phase = 0.0;
+    int fill = 0;
+    auto next = std::chrono::steady_clock::now();
+
+    while (running_.load(std::memory_order_relaxed)) {
+        auto& buf = bufs_[static_cast<std::size_t>(fill)];
+        for (std::size_t i = 0; i < n_; ++i) {
+            buf[i] = static_cast<float>(cfg_.amplitude * std::sin(phase) + cfg_.noise * noise(rng));
+            phase += phase_step;
+        }
+        phase = std::fmod(phase, 2.0 * std::numbers::pi);
+
+        // paced like a DMA completion interrupt
+        next += block_period;
+        std::this_thread::sleep_until(next);
+
+        // hand off only if the consumer has released the other buffer; otherwise drop and refill
+        if (handoff_state_.load(std::memory_order_acquire) == kFree) {
+            handoff_idx_ = fill;
+            handoff_state_.store(kReady, std::memory_order_release);
+            fill ^= 1;
+        } else {
+            overruns_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+bool WaveformChannel::poll(WaveformFeatures& out) {
+    int expected = kReady;
+    if (!handoff_state_.compare_exchange_strong(expected, kConsuming, std::memory_order_acquire)) return false;
+
+    const auto& block = bufs_[static_cast<std::size_t>(handoff_idx_)];
+
+    const auto t0 = std::chrono::steady_clock::now();
+    extract_(block, out);
+    const auto t1 = std::chrono::steady_clock::now();
+
+    if (snippet_requested_.exchange(false, std::memory_order_relaxed)) {
+        const auto len = std::min(n_, static_cast<std::size_t>(cfg_.snippet_len));
+        snippet_.assign(block.begin(), block.begin() + static_cast<std::ptrdiff_t>(len));
+        snippet_ready_ = true;
+    }
+
+    handoff_state_.store(kFree, std::memory_order_release);
+
+    ++blocks_;
+    process_ns_ += static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+    return true;
+}
+
+void WaveformChannel::extract_(const std::vector<float>& block, WaveformFeatures& out) {
+    const float* x = block.data();
+    const double n = static_cast<double>(n_);
+
+    out.mean = dsp::sum(x, n_) / n;
+    out.rms = std::sqrt(dsp::sum_squares(x, n_) / n);
+    out.peak = dsp::max_abs(x, n_);
+    out.crest_factor = out.rms > 0.0 ? out.peak / out.rms : 0.0;
+
+    if (band_bins_.empty()) return;
+
+    dsp::multiply(x, window_.data(), re_.data(), n_);
+    std::fill(im_.begin(), im_.end(), 0.0f);
+    fft_.forward(re_.data(), im_.data());
+    dsp::power(re_.data(), im_.data(), pow_.data(), pow_.size());
+
+    // one-sided spectrum scaled so a sine of amplitude A contributes ~A^2/2 (its mean square)
+    const double scale = 2.0 / (n * window_power_);
+    out.band_energy.resize(band_bins_.size());
+    for (std::size_t b = 0; b < band_bins_.size(); ++b) {
+        double energy = 0.0;
+        for (std::size_t k = band_bins_[b].first; k <= band_bins_[b].second; ++k) {
+            const double edge = (k == 0 || k == n_ / 2) ? 0.5 : 1.0;
+            energy += edge * pow_[k];
+        }
+        out.band_energy[b] = energy * scale;
+    }
+}
+
+bool WaveformChannel::take_snippet(std::vector<float>& out) {
+    if (!snippet_ready_) return false;
+    out.swap(snippet_);
+    snippet_.clear();
+    snippet_ready_ = false;
+    return true;
+}
+
+double WaveformChannel::samples_per_s() const noexcept {
+    if (process_ns_ == 0) return 0.0;
+    return static_cast<double>(blocks_ * n_) * 1e9 / static_cast<double>(process_ns_);
+}
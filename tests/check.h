@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdio>
+
+// Tiny assertion helpers for the test executables: failures are counted, not fatal,
+// and main() returns test::exit_code().
+namespace test {
+
+    inline int& failures() {
+        static int count = 0;
+        return count;
+    }
+
+    inline int exit_code() {
+        if (failures() == 0) {
+            std::printf("OK\n");
+            return 0;
+        }
+        std::printf("%d check(s) failed\n", failures());
+        return 1;
+    }
+
+} // namespace test
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            ++test::failures(); \
+        } \
+    } while (0)
+
+#define CHECK_MSG(cond, ...) \
+    do { \
+        if (!(cond)) { \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s: ", __FILE__, __LINE__, #cond); \
+            std::fprintf(stderr, __VA_ARGS__); \
+            std::fprintf(stderr, "\n"); \
+            ++test::failures(); \
+        } \
+    } while (0)
@@ -0,0 +1,84 @@
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+
+#include "app_config.h"
+#include "check.h"
+
+// load_config_or_throw on small inline configs: what is accepted and what is rejected at startup.
+
+namespace {
+
+    const std::string kMetrics = R"(
+        { "name": "temperature", "unit": "C", "type": "simulated", "topic_suffix": "temp" },
+        { "name": "vibration", "unit": "g", "type": "waveform", "topic_suffix": "vibration",
+          "waveform": { "sample_rate_hz": 25600, "block_size": 4096 } })";
+
+    std::string path() { return "/tmp/telemetry-config-test-" + std::to_string(getpid()) + ".json"; }
+
+    // Returns the load error, or an empty string if the config was accepted.
+    std::string load(const std::string& json) {
+        {
+            std::ofstream file(path());
+            file << json;
+        }
+        try {
+            load_config_or_throw(path());
+            return {};
+        } catch (const std::exception& e) {
+            return e.what();
+        }
+    }
+
+    std::string with_rules(const std::string& rules) {
+        return R"({ "client_id": "test", "metrics": [)" + kMetrics + R"(], "rules": [)" + rules + "] }";
+    }
+
+    void test_rules_on_waveform_metrics() {
+        CHECK(load(with_rules(R"({ "name": "hot", "metric": "temperature", "op": ">", "value": 80 })")).empty());
+
+        const auto err = load(with_rules(R"({ "name": "shake", "metric": "vibration", "op": ">", "value": 1 })"));
+        CHECK_MSG(err.find("waveform metric: vibration") != std::string::npos, "got '%s'", err.c_str());
+
+        const auto with_err = load(with_rules(R"({ "name": "both", "kind": "band", "metric": "temperature", "low": 0, "high": 50,
+                                                   "with": { "metric": "vibration", "low": 0, "high": 1 } })"));
+        CHECK_MSG(with_err.find("waveform metric: vibration") != std::string::npos, "got '%s'", with_err.c_str());
+    }
+
+    void test_shm_name_length() {
+        const std::string name47(47, 'm');
+        const std::string name48(48, 'm');
+        const auto config = [](const std::string& name, bool shm) {
+            return R"({ "client_id": "test", "shm": { "enabled": )" + std::string(shm ? "true" : "false") +
+                   R"( }, "metrics": [ { "name": ")" + name + R"(", "type": "simulated", "topic_suffix": "x" } ] })";
+        };
+
+        CHECK(load(config(name47, true)).empty());
+        CHECK(load(config(name48, false)).empty());
+        const auto err = load(config(name48, true));
+        CHECK_MSG(err.find("longer than 47 bytes") != std::string::npos, "got '%s'", err.c_str());
+    }
+
+    void test_tls_off_by_default() {
+        // switched off without "enabled", so the missing ca_file is not an error
+        const auto config = [](const std::string& tls) {
+            return R"({ "client_id": "test", "broker": { "tls": { )" + tls + R"( } }, "metrics": [)" + kMetrics + "] }";
+        };
+        CHECK(load(config(R"("alpn": "mqtt")")).empty());
+
+        const auto err = load(config(R"("enabled": true, "alpn": "mqtt")"));
+        CHECK_MSG(err.find("ca_file must not be empty") != std::string::npos, "got '%s'", err.c_str());
+    }
+
+} // namespace
+
+int main() {
+    test_rules_on_waveform_metrics();
+    test_shm_name_length();
+    test_tls_off_by_default();
+
+    std::remove(path().c_str());
+    return test::exit_code();
+}
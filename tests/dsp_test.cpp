@@ -0,0 +1,106 @@
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <numbers>
+#include <random>
+#include <vector>
+
+#include "check.h"
+#include "dsp_kernels.h"
+
+// The SIMD kernels against plain double-precision references, at sizes that exercise both the
+// vector body and the scalar tail.
+
+namespace {
+
+    std::vector<float> random_block(std::size_t n, unsigned seed) {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+        std::vector<float> x(n);
+        for (auto& v : x) v = dist(rng);
+        return x;
+    }
+
+    void test_reductions() {
+        for (const std::size_t n : {1u, 3u, 4u, 7u, 64u, 4097u}) {
+            const auto x = random_block(n, static_cast<unsigned>(n));
+            double sum = 0.0;
+            double squares = 0.0;
+            float peak = 0.0f;
+            for (const float v : x) {
+                sum += v;
+                squares += static_cast<double>(v) * v;
+                peak = std::fmax(peak, std::fabs(v));
+            }
+            CHECK_MSG(std::fabs(dsp::sum(x.data(), n) - sum) < 1e-4 * static_cast<double>(n), "sum, n=%zu", n);
+            CHECK_MSG(std::fabs(dsp::sum_squares(x.data(), n) - squares) < 1e-4 * static_cast<double>(n), "sum_squares, n=%zu", n);
+            CHECK_MSG(dsp::max_abs(x.data(), n) == peak, "max_abs, n=%zu", n);
+
+            const auto y = random_block(n, static_cast<unsigned>(n + 1));
+            std::vector<float> out(n);
+            dsp::multiply(x.data(), y.data(), out.data(), n);
+            bool ok = true;
+            for (std::size_t i = 0; i < n; ++i) ok = ok && out[i] == x[i] * y[i];
+            CHECK_MSG(ok, "multiply, n=%zu", n);
+
+            dsp::power(x.data(), y.data(), out.data(), n);
+            ok = true;
+            for (std::size_t i = 0; i < n; ++i) ok = ok && std::fabs(out[i] - (x[i] * x[i] + y[i] * y[i])) < 1e-6f;
+            CHECK_MSG(ok, "power, n=%zu", n);
+        }
+    }
+
+    void test_fft_matches_dft() {
+        for (std::size_t n = 2; n <= 2048; n <<= 1) {
+            auto re = random_block(n, static_cast<unsigned>(3 * n));
+            auto im = random_block(n, static_cast<unsigned>(3 * n + 1));
+
+            std::vector<std::complex<double>> expected(n);
+            for (std::size_t k = 0; k < n; ++k) {
+                for (std::size_t t = 0; t < n; ++t) {
+                    const double angle = -2.0 * std::numbers::pi * static_cast<double>(k * t % n) / static_cast<double>(n);
+                    expected[k] += std::complex<double>(re[t], im[t]) * std::polar(1.0, angle);
+                }
+            }
+
+            const dsp::Fft fft(n);
+            fft.forward(re.data(), im.data());
+
+            double worst = 0.0;
+            for (std::size_t k = 0; k < n; ++k) {
+                worst = std::max(worst, std::abs(std::complex<double>(re[k], im[k]) - expected[k]));
+            }
+            // float accumulation error grows ~log2(n); inputs are O(1), outputs O(sqrt(n))
+            CHECK_MSG(worst < 1e-5 * static_cast<double>(n), "fft n=%zu off by %g", n, worst);
+        }
+    }
+
+    void test_fft_sine_bin() {
+        constexpr std::size_t n = 4096;
+        constexpr std::size_t bin = 100;
+        std::vector<float> re(n);
+        std::vector<float> im(n, 0.0f);
+        for (std::size_t t = 0; t < n; ++t) {
+            re[t] = static_cast<float>(std::sin(2.0 * std::numbers::pi * bin * static_cast<double>(t) / n));
+        }
+
+        dsp::Fft(n).forward(re.data(), im.data());
+        std::vector<float> power(n / 2 + 1);
+        dsp::power(re.data(), im.data(), power.data(), power.size());
+
+        std::size_t peak = 0;
+        for (std::size_t k = 1; k < power.size(); ++k) if (power[k] > power[peak]) peak = k;
+        CHECK(peak == bin);
+        // |X[bin]| = n/2 for a unit sine
+        CHECK(std::fabs(std::sqrt(power[bin]) - n / 2.0) < 1e-2 * n);
+    }
+
+} // namespace
+
+int main() {
+    std::printf("dsp kernels: %.*s\n", static_cast<int>(dsp::isa().size()), dsp::isa().data());
+    test_reductions();
+    test_fft_matches_dft();
+    test_fft_sine_bin();
+    return test::exit_code();
+}
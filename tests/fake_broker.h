@@ -0,0 +1,71 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Control side of tests/fake_mosquitto.cpp, a scripted in-process stand-in for libmosquitto
+// and the broker behind it. Link it instead of libmosquitto; only one client is supported.
+// Each connect attempt opens a socketpair, so MqttClient::drop_connection() shutting down
+// the client end is seen as a lost connection, like a real TCP drop. The loop thread started
+// by mosquitto_loop_start() also reconnects on its own, as libmosquitto's does.
+namespace fake_broker {
+
+    using Clock = std::chrono::steady_clock;
+
+    enum class Outcome {
+        Pending,
+        TcpRefused,     // mosquitto_(re)connect failed with ECONNREFUSED
+        ConnackRefused, // CONNACK with a non-zero return code
+        Abandoned,      // another (re)connect replaced it before its CONNACK
+        Accepted
+    };
+
+    enum class Origin {
+        Client,  // mosquitto_connect_async / mosquitto_reconnect_async
+        Library  // the loop thread's own reconnect after reconnect_delay
+    };
+
+    struct Attempt {
+        Clock::time_point at;
+        Clock::time_point resolved;
+        Outcome outcome = Outcome::Pending;
+        Origin origin = Origin::Client;
+    };
+
+    struct Counters {
+        std::uint64_t attempts = 0;
+        std::uint64_t library_reconnects = 0; // attempts made by the loop thread itself
+        std::uint64_t publishes = 0;
+        std::uint64_t rejected_publishes = 0; // publish while not connected
+        std::uint64_t lwt_published = 0;      // connection lost without DISCONNECT
+        std::uint64_t clean_disconnects = 0;
+    };
+
+    // Faults, applied to the next connect attempts in order: TCP refusals first, then CONNACK
+    // refusals; delays hold back the CONNACK of the next accepted attempts.
+    void refuse_tcp(int attempts);
+    void refuse_connack(int attempts);
+    void delay_connack(std::chrono::milliseconds delay, int attempts = 1);
+
+    // Broker side closes the connection (the client sees MOSQ_ERR_CONN_LOST).
+    void drop();
+
+    // Delivers a message on a subscribed topic from the client's loop.
+    void inject_message(std::string topic, std::string payload);
+
+    bool connected();
+    Counters counters();
+    Clock::time_point last_loss(); // when the last established connection was lost
+
+    // Returns and clears the attempt log, oldest first.
+    std::vector<Attempt> take_attempts();
+
+    // Called for every accepted publish and LWT, with the broker lock held; must not call back in.
+    using PublishHook = std::function<void(std::string_view topic, std::string_view payload, bool retain)>;
+    void set_publish_hook(PublishHook hook);
+
+} // namespace fake_broker
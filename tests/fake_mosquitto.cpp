@@ -0,0 +1,460 @@
+#include <mosquitto.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "fake_broker.h"
+
+// The libmosquitto entry points MqttClient uses, backed by a scripted broker.
+//
+// mosquitto_loop_start() runs a loop thread shaped like libmosquitto 2.0's loop_forever():
+// it services the socket, and after a lost or refused connection it sleeps reconnect_delay
+// (1 s, the library default) and reconnects on its own. As in the real library, the CONNECT
+// queued by a (re)connect_async() from another thread is only written by the loop thread,
+// and queuing it interrupts the loop thread's reconnect sleep; the sleep first discards
+// wake-ups that arrived before it started. Callbacks run on the loop thread.
+
+struct mosquitto {
+    int unused = 0;
+};
+
+namespace {
+
+    using fake_broker::Attempt;
+    using fake_broker::Clock;
+    using fake_broker::Origin;
+    using fake_broker::Outcome;
+
+    enum class State { Idle, Connecting, Active, Disconnecting };
+
+    struct Broker {
+        std::mutex mtx;
+
+        mosquitto client;
+        void* userdata = nullptr;
+        void (*on_connect)(mosquitto*, void*, int) = nullptr;
+        void (*on_disconnect)(mosquitto*, void*, int) = nullptr;
+        void (*on_message)(mosquitto*, void*, const mosquitto_message*) = nullptr;
+
+        std::string will_topic;
+        std::string will_payload;
+        bool will_retain = false;
+
+        State state = State::Idle;
+        int client_fd = -1; // returned by mosquitto_socket()
+        int broker_fd = -1;
+        bool connect_sent = false; // the loop thread has written CONNECT on this socket
+        Clock::time_point connack_due {};
+        int connack_rc = 0;
+        bool disconnect_requested = false; // mosquitto_disconnect() until the next (re)connect
+
+        std::thread loop_thread;
+        std::condition_variable wake_cv;
+        bool wake = false; // a packet was queued from outside the loop thread
+        bool stop_loop = false;
+        std::chrono::milliseconds reconnect_delay {1000};
+
+        int tcp_refusals = 0;
+        int connack_refusals = 0;
+        int delayed_acks = 0;
+        std::chrono::milliseconds ack_delay {0};
+        bool drop_requested = false;
+
+        std::vector<std::string> subscriptions;
+        std::deque<std::pair<std::string, std::string>> inbox;
+
+        std::vector<Attempt> attempts;
+        fake_broker::Counters counters;
+        Clock::time_point last_loss {};
+        fake_broker::PublishHook hook;
+    };
+
+    Broker& broker() {
+        static Broker b;
+        return b;
+    }
+
+    void close_sockets(Broker& b) {
+        if (b.client_fd >= 0) ::close(b.client_fd);
+        if (b.broker_fd >= 0) ::close(b.broker_fd);
+        b.client_fd = -1;
+        b.broker_fd = -1;
+    }
+
+    void resolve_pending(Broker& b, Outcome outcome) {
+        for (auto it = b.attempts.rbegin(); it != b.attempts.rend(); ++it) {
+            if (it->outcome != Outcome::Pending) continue;
+            it->outcome = outcome;
+            it->resolved = Clock::now();
+            return;
+        }
+    }
+
+    // Connection ended without DISCONNECT: the broker publishes the will.
+    void lose_connection(Broker& b) {
+        if (b.state == State::Active) {
+            ++b.counters.lwt_published;
+            b.last_loss = Clock::now();
+            if (b.hook && !b.will_topic.empty()) b.hook(b.will_topic, b.will_payload, b.will_retain);
+        } else if (b.state == State::Connecting) {
+            resolve_pending(b, Outcome::Abandoned);
+        }
+        close_sockets(b);
+        b.state = State::Idle;
+        b.subscriptions.clear();
+    }
+
+    int begin_attempt(Origin origin) {
+        auto& b = broker();
+        std::lock_guard<std::mutex> lock(b.mtx);
+
+        // like the real library, a (re)connect first drops whatever socket is open
+        if (b.state != State::Idle) lose_connection(b);
+
+        ++b.counters.attempts;
+        if (origin == Origin::Library) ++b.counters.library_reconnects;
+        b.drop_requested = false;
+        b.disconnect_requested = false;
+        b.attempts.push_back(Attempt {Clock::now(), {}, Outcome::Pending, origin});
+
+        if (b.tcp_refusals > 0) {
+            --b.tcp_refusals;
+            resolve_pending(b, Outcome::TcpRefused);
+            errno = ECONNREFUSED;
+            return MOSQ_ERR_ERRNO;
+        }
+
+        int fds[2];
+        if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) != 0) return MOSQ_ERR_ERRNO;
+        b.client_fd = fds[0];
+        b.broker_fd = fds[1];
+        b.state = State::Connecting;
+        b.connect_sent = false;
+
+        if (origin == Origin::Client) {
+            b.wake = true;
+            b.wake_cv.notify_all();
+        }
+        return MOSQ_ERR_SUCCESS;
+    }
+
+    // The loop thread writes CONNECT; the broker decides on the CONNACK when it arrives.
+    void send_connect(Broker& b) {
+        b.connect_sent = true;
+        b.connack_rc = 0;
+        if (b.connack_refusals > 0) {
+            --b.connack_refusals;
+            b.connack_rc = 5; // not authorised
+        }
+        b.connack_due = Clock::now();
+        if (b.connack_rc == 0 && b.delayed_acks > 0) {
+            --b.delayed_acks;
+            b.connack_due += b.ack_delay;
+        }
+    }
+
+    // The client shut its end down (MqttClient::drop_connection()).
+    bool client_hung_up(const Broker& b) {
+        if (b.broker_fd < 0) return false;
+        pollfd pfd {b.broker_fd, POLLIN, 0};
+        if (::poll(&pfd, 1, 0) <= 0) return false;
+        char byte;
+        return ::recv(b.broker_fd, &byte, 1, MSG_DONTWAIT) == 0;
+    }
+
+} // namespace
+
+// ---- control API ----
+namespace fake_broker {
+
+    void refuse_tcp(int attempts) {
+        std::lock_guard<std::mutex> lock(broker().mtx);
+        broker().tcp_refusals += attempts;
+    }
+
+    void refuse_connack(int attempts) {
+        std::lock_guard<std::mutex> lock(broker().mtx);
+        broker().connack_refusals += attempts;
+    }
+
+    void delay_connack(std::chrono::milliseconds delay, int attempts) {
+        std::lock_guard<std::mutex> lock(broker().mtx);
+        broker().ack_delay = delay;
+        broker().delayed_acks += attempts;
+    }
+
+    void drop() {
+        std::lock_guard<std::mutex> lock(broker().mtx);
+        broker().drop_requested = true;
+    }
+
+    void inject_message(std::string topic, std::string payload) {
+        std::lock_guard<std::mutex> lock(broker().mtx);
+        broker().inbox.emplace_back(std::move(topic), std::move(payload));
+    }
+
+    bool connected() {
+        std::lock_guard<std::mutex> lock(broker().mtx);
+        return broker().state == State::Active;
+    }
+
+    Counters counters() {
+        std::lock_guard<std::mutex> lock(broker().mtx);
+        return broker().counters;
+    }
+
+    Clock::time_point last_loss() {
+        std::lock_guard<std::mutex> lock(broker().mtx);
+        return broker().last_loss;
+    }
+
+    std::vector<Attempt> take_attempts() {
+        std::lock_guard<std::mutex> lock(broker().mtx);
+        std::vector<Attempt> out;
+        out.swap(broker().attempts);
+        // keep an attempt that is still in flight so its outcome is not lost
+        if (!out.empty() && out.back().outcome == Outcome::Pending) {
+            broker().attempts.push_back(out.back());
+            out.pop_back();
+        }
+        return out;
+    }
+
+    void set_publish_hook(PublishHook hook) {
+        std::lock_guard<std::mutex> lock(broker().mtx);
+        broker().hook = std::move(hook);
+    }
+
+} // namespace fake_broker
+
+// ---- libmosquitto API ----
+int mosquitto_lib_init(void) { return MOSQ_ERR_SUCCESS; }
+int mosquitto_lib_cleanup(void) { return MOSQ_ERR_SUCCESS; }
+
+struct mosquitto* mosquitto_new(const char*, bool, void* obj) {
+    broker().userdata = obj;
+    return &broker().client;
+}
+
+void mosquitto_destroy(struct mosquitto* mosq) {
+    mosquitto_loop_stop(mosq, true);
+    std::lock_guard<std::mutex> lock(broker().mtx);
+    close_sockets(broker());
+    broker().state = State::Idle;
+}
+
+void mosquitto_connect_callback_set(struct mosquitto*, void (*cb)(struct mosquitto*, void*, int)) { broker().on_connect = cb; }
+void mosquitto_disconnect_callback_set(struct mosquitto*, void (*cb)(struct mosquitto*, void*, int)) { broker().on_disconnect = cb; }
+void mosquitto_message_callback_set(struct mosquitto*, void (*cb)(struct mosquitto*, void*, const struct mosquitto_message*)) {
+    broker().on_message = cb;
+}
+
+int mosquitto_will_set(struct mosquitto*, const char* topic, int payloadlen, const void* payload, int, bool retain) {
+    auto& b = broker();
+    std::lock_guard<std::mutex> lock(b.mtx);
+    b.will_topic = topic;
+    b.will_payload.assign(static_cast<const char*>(payload), static_cast<std::size_t>(payloadlen));
+    b.will_retain = retain;
+    return MOSQ_ERR_SUCCESS;
+}
+
+int mosquitto_connect_async(struct mosquitto*, const char*, int, int) { return begin_attempt(Origin::Client); }
+int mosquitto_reconnect_async(struct mosquitto*) { return begin_attempt(Origin::Client); }
+
+int mosquitto_disconnect(struct mosquitto*) {
+    auto& b = broker();
+    std::lock_guard<std::mutex> lock(b.mtx);
+    // the loop thread stops reconnecting even if there is no connection to close
+    b.disconnect_requested = true;
+    b.wake_cv.notify_all();
+    if (b.state != State::Active && b.state != State::Connecting) return MOSQ_ERR_NO_CONN;
+    b.state = State::Disconnecting;
+    return MOSQ_ERR_SUCCESS;
+}
+
+int mosquitto_socket(struct mosquitto*) {
+    std::lock_guard<std::mutex> lock(broker().mtx);
+    return broker().client_fd;
+}
+
+namespace {
+
+    // One mosquitto_loop() call: services the socket for up to `timeout` ms.
+    int loop_once(struct mosquitto* mosq, int timeout) {
+        auto& b = broker();
+        const auto deadline = Clock::now() + std::chrono::milliseconds(timeout);
+
+        for (;;) {
+            std::unique_lock<std::mutex> lock(b.mtx);
+
+            if (b.state == State::Idle) return MOSQ_ERR_NO_CONN;
+
+            if (b.state == State::Disconnecting) {
+                ++b.counters.clean_disconnects;
+                close_sockets(b);
+                b.state = State::Idle;
+                lock.unlock();
+                if (b.on_disconnect) b.on_disconnect(mosq, b.userdata, 0);
+                return MOSQ_ERR_SUCCESS;
+            }
+
+            // loop_stop(): DISCONNECT queued just before it is still written (above)
+            if (b.stop_loop) return MOSQ_ERR_SUCCESS;
+
+            if ((b.drop_requested && b.state == State::Active) || client_hung_up(b)) {
+                b.drop_requested = false;
+                lose_connection(b);
+                lock.unlock();
+                if (b.on_disconnect) b.on_disconnect(mosq, b.userdata, MOSQ_ERR_CONN_LOST);
+                return MOSQ_ERR_CONN_LOST;
+            }
+
+            if (b.state == State::Connecting && !b.connect_sent) send_connect(b);
+
+            if (b.state == State::Connecting && Clock::now() >= b.connack_due) {
+                const int rc = b.connack_rc;
+                if (rc == 0) {
+                    b.state = State::Active;
+                    resolve_pending(b, Outcome::Accepted);
+                } else {
+                    resolve_pending(b, Outcome::ConnackRefused);
+                    close_sockets(b);
+                    b.state = State::Idle;
+                }
+                lock.unlock();
+                if (b.on_connect) b.on_connect(mosq, b.userdata, rc);
+                if (rc == 0) return MOSQ_ERR_SUCCESS;
+                if (b.on_disconnect) b.on_disconnect(mosq, b.userdata, MOSQ_ERR_CONN_REFUSED);
+                return MOSQ_ERR_CONN_REFUSED;
+            }
+
+            if (b.state == State::Active && !b.inbox.empty()) {
+                auto [topic, payload] = std::move(b.inbox.front());
+                b.inbox.pop_front();
+                const bool subscribed = std::find(b.subscriptions.begin(), b.subscriptions.end(), topic) != b.subscriptions.end();
+                lock.unlock();
+                if (subscribed && b.on_message) {
+                    mosquitto_message msg {};
+                    msg.topic = topic.data();
+                    msg.payload = payload.data();
+                    msg.payloadlen = static_cast<int>(payload.size());
+                    b.on_message(mosq, b.userdata, &msg);
+                }
+                return MOSQ_ERR_SUCCESS;
+            }
+
+            const auto now = Clock::now();
+            if (now >= deadline) return MOSQ_ERR_SUCCESS;
+
+            // sleep until the deadline, a due CONNACK or the client hanging up, whichever is first
+            auto wake = std::min(deadline, now + std::chrono::milliseconds(5));
+            if (b.state == State::Connecting) wake = std::min(wake, b.connack_due);
+            pollfd pfd {b.broker_fd, POLLIN, 0};
+            lock.unlock();
+
+            const auto wait_ms = std::chrono::duration_cast<std::chrono::milliseconds>(wake - now).count();
+            ::poll(&pfd, pfd.fd >= 0 ? 1 : 0, static_cast<int>(std::max<long long>(wait_ms, 0)));
+        }
+    }
+
+    bool loop_stopping(Broker& b) {
+        std::lock_guard<std::mutex> lock(b.mtx);
+        return b.stop_loop;
+    }
+
+    // libmosquitto's loop_forever(): service the connection, and once it is gone sleep
+    // reconnect_delay and reconnect (blocking) until that succeeds or the client disconnects.
+    void loop_forever(struct mosquitto* mosq) {
+        auto& b = broker();
+        for (;;) {
+            int rc = MOSQ_ERR_SUCCESS;
+            do {
+                rc = loop_once(mosq, 1000);
+            } while (rc == MOSQ_ERR_SUCCESS && !loop_stopping(b));
+            if (loop_stopping(b)) return;
+
+            do {
+                {
+                    std::unique_lock<std::mutex> lock(b.mtx);
+                    if (b.disconnect_requested || b.stop_loop) return;
+                    b.wake = false;
+                    b.wake_cv.wait_for(lock, b.reconnect_delay, [&b] { return b.wake || b.stop_loop || b.disconnect_requested; });
+                    if (b.disconnect_requested || b.stop_loop) return;
+                }
+                rc = begin_attempt(Origin::Library);
+            } while (rc != MOSQ_ERR_SUCCESS);
+        }
+    }
+
+} // namespace
+
+int mosquitto_loop_start(struct mosquitto* mosq) {
+    auto& b = broker();
+    if (b.loop_thread.joinable()) return MOSQ_ERR_INVAL;
+    b.stop_loop = false;
+    b.loop_thread = std::thread(loop_forever, mosq);
+    return MOSQ_ERR_SUCCESS;
+}
+
+int mosquitto_loop_stop(struct mosquitto*, bool) {
+    auto& b = broker();
+    {
+        std::lock_guard<std::mutex> lock(b.mtx);
+        b.stop_loop = true;
+        b.wake_cv.notify_all();
+    }
+    if (b.loop_thread.joinable()) b.loop_thread.join();
+    return MOSQ_ERR_SUCCESS;
+}
+
+int mosquitto_publish(struct mosquitto*, int*, const char* topic, int payloadlen, const void* payload, int, bool retain) {
+    auto& b = broker();
+    std::lock_guard<std::mutex> lock(b.mtx);
+    if (b.state != State::Active) {
+        ++b.counters.rejected_publishes;
+        return MOSQ_ERR_NO_CONN;
+    }
+    ++b.counters.publishes;
+    if (b.hook) b.hook(topic, std::string_view(static_cast<const char*>(payload), static_cast<std::size_t>(payloadlen)), retain);
+    return MOSQ_ERR_SUCCESS;
+}
+
+int mosquitto_subscribe(struct mosquitto*, int*, const char* sub, int) {
+    auto& b = broker();
+    std::lock_guard<std::mutex> lock(b.mtx);
+    if (b.state != State::Active) return MOSQ_ERR_NO_CONN;
+    b.subscriptions.emplace_back(sub);
+    return MOSQ_ERR_SUCCESS;
+}
+
+const char* mosquitto_strerror(int mosq_errno) {
+    switch (mosq_errno) {
+        case MOSQ_ERR_SUCCESS: return "No error.";
+        case MOSQ_ERR_NO_CONN: return "The client is not currently connected.";
+        case MOSQ_ERR_CONN_REFUSED: return "The connection was refused.";
+        case MOSQ_ERR_CONN_LOST: return "The connection was lost.";
+        case MOSQ_ERR_ERRNO: return "Connection refused (fake broker).";
+        default: return "Unknown error (fake broker).";
+    }
+}
+
+// TLS is not exercised by the fake broker
+int mosquitto_tls_set(struct mosquitto*, const char*, const char*, const char*, const char*, int (*)(char*, int, int, void*)) {
+    return MOSQ_ERR_SUCCESS;
+}
+int mosquitto_tls_opts_set(struct mosquitto*, int, const char*, const char*) { return MOSQ_ERR_SUCCESS; }
+int mosquitto_tls_insecure_set(struct mosquitto*, bool) { return MOSQ_ERR_SUCCESS; }
+int mosquitto_int_option(struct mosquitto*, enum mosq_opt_t, int) { return MOSQ_ERR_SUCCESS; }
+int mosquitto_string_option(struct mosquitto*, enum mosq_opt_t, const char*) { return MOSQ_ERR_SUCCESS; }
+int mosquitto_void_option(struct mosquitto*, enum mosq_opt_t, void*) { return MOSQ_ERR_SUCCESS; }
+void* mosquitto_ssl_get(struct mosquitto*) { return nullptr; }
@@ -0,0 +1,94 @@
+#include <cstring>
+#include <string>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <vector>
+
+#include "check.h"
+#include "ingest_socket.h"
+#include "logger.h"
+
+namespace {
+
+    bool send_datagram(const std::string& path, const std::string& data) {
+        const int fd = ::socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+        sockaddr_un addr {};
+        addr.sun_family = AF_UNIX;
+        std::memcpy(addr.sun_path, path.c_str(), path.size());
+        const ssize_t n = ::sendto(fd, data.data(), data.size(), 0, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr));
+        ::close(fd);
+        return n == static_cast<ssize_t>(data.size());
+    }
+
+    std::vector<Reading> drain(IngestSocket& ingest) {
+        std::vector<Reading> out;
+        ingest.drain(out, IngestSocket::Clock::now());
+        return out;
+    }
+
+    void test_socket_mode(const std::string& path) {
+        for (const mode_t mode : {mode_t {0600}, mode_t {0660}}) {
+            IngestSocket ingest(path, 100.0, 10.0, mode);
+            CHECK(ingest.start());
+
+            struct stat st {};
+            CHECK(::stat(path.c_str(), &st) == 0);
+            CHECK(S_ISSOCK(st.st_mode));
+            CHECK_MSG((st.st_mode & 07777) == mode, "socket mode %o, expected %o",
+                      static_cast<unsigned>(st.st_mode & 07777), static_cast<unsigned>(mode));
+        }
+    }
+
+    void test_name_validation(const std::string& path) {
+        // "temp" and "humidity" are configured topic_suffix values
+        IngestSocket ingest(path, 100.0, 100.0, 0600, {"temp", "humidity"});
+        CHECK(ingest.start());
+
+        CHECK(send_datagram(path, "pressure 101.3 kPa\nflow 2.5 l/min\n"));
+        CHECK(send_datagram(path, "temp 99\nhumidity 1\nhealth 1\nstatus 0\nevents 1\n"));
+        CHECK(send_datagram(path, "a/b 1\nx+ 1\n# 1\nok 1 unit extra\nbad nan\n"));
+        CHECK(send_datagram(path, "temperature 21.5 C\n"));
+
+        const auto readings = drain(ingest);
+        CHECK(readings.size() == 3);
+        if (readings.size() == 3) {
+            CHECK(readings[0].metric_name == "pressure" && readings[0].unit == "kPa");
+            CHECK(readings[1].metric_name == "flow");
+            // only the exact topic level is reserved
+            CHECK(readings[2].metric_name == "temperature" && readings[2].value == 21.5);
+        }
+        CHECK(ingest.accepted() == 3);
+        CHECK(ingest.invalid() == 10);
+        CHECK(ingest.datagrams() == 4);
+    }
+
+    void test_rate_limit(const std::string& path) {
+        IngestSocket ingest(path, 1.0, 5.0);
+        CHECK(ingest.start());
+
+        CHECK(send_datagram(path, "a 1\na 2\na 3\na 4\na 5\na 6\na 7\n"));
+        CHECK(drain(ingest).size() == 5);
+        CHECK(ingest.rate_limited() == 2);
+
+        const auto producers = ingest.producers();
+        CHECK(producers.size() == 1);
+        if (!producers.empty()) {
+            CHECK(producers[0].pid == getpid());
+            CHECK(producers[0].accepted == 5 && producers[0].rate_limited == 2);
+        }
+    }
+
+} // namespace
+
+int main() {
+    logger::set_level(logger::Level::Off);
+
+    const std::string path = "/tmp/telemetry-ingest-test-" + std::to_string(getpid()) + ".sock";
+    test_socket_mode(path);
+    test_name_validation(path);
+    test_rate_limit(path);
+
+    return test::exit_code();
+}
@@ -0,0 +1,151 @@
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "app_config.h"
+#include "check.h"
+#include "latest_value_reader.h"
+#include "latest_value_table.h"
+#include "logger.h"
+
+// LatestValueTable (writer) against LatestValueReader: layout and names, a writer updating as
+// fast as it can while reader threads check that no snapshot mixes two writes, and readers
+// noticing a daemon restart.
+
+namespace {
+
+    MetricConfig metric(const std::string& name, const std::string& unit) {
+        MetricConfig m;
+        m.name = name;
+        m.unit = unit;
+        m.topic_suffix = name;
+        return m;
+    }
+
+    // Every write keeps value, timestamp and seq in a fixed relation, so a torn read shows up
+    // as a mismatch between them.
+    void write(LatestValueTable& table, std::size_t idx, std::uint64_t n) {
+        table.update(idx, static_cast<double>(n) + 0.5, static_cast<std::int64_t>(n) * 10, n);
+    }
+
+    bool consistent(const LatestValue& v) {
+        return v.value == static_cast<double>(v.seq) + 0.5 && v.timestamp_ms == static_cast<std::int64_t>(v.seq) * 10;
+    }
+
+    void test_layout(const std::string& shm_name) {
+        LatestValueTable table(shm_name, {metric("temperature", "C"), metric("humidity", "%")});
+        CHECK(table.open());
+
+        LatestValueReader reader;
+        CHECK(reader.open(shm_name.c_str()));
+        CHECK(reader.size() == 2);
+        CHECK(reader.find("humidity") == 1);
+        CHECK(reader.unit(0) == "C");
+        CHECK(reader.find("pressure") == -1);
+
+        LatestValue v {};
+        CHECK_MSG(!reader.read(0, v), "unwritten entry returned a value");
+        write(table, 0, 7);
+        CHECK(reader.read(0, v) && v.seq == 7 && consistent(v));
+        CHECK(!reader.read(2, v));
+    }
+
+    void test_no_torn_reads(const std::string& shm_name) {
+        constexpr int kReaders = 3;
+        constexpr auto kDuration = std::chrono::milliseconds(1500);
+
+        LatestValueTable table(shm_name, {metric("a", ""), metric("b", "")});
+        CHECK(table.open());
+        write(table, 0, 1);
+        write(table, 1, 1);
+
+        std::atomic<bool> stop {false};
+        std::atomic<std::uint64_t> reads {0};
+        std::atomic<std::uint64_t> torn {0};
+        std::atomic<std::uint64_t> backwards {0};
+
+        std::vector<std::thread> readers;
+        for (int r = 0; r < kReaders; ++r) {
+            readers.emplace_back([&] {
+                LatestValueReader reader;
+                if (!reader.open(shm_name.c_str())) {
+                    torn.fetch_add(1);
+                    return;
+                }
+                std::uint64_t last[2] = {0, 0};
+                std::uint64_t local_reads = 0;
+                while (!stop.load(std::memory_order_relaxed)) {
+                    for (std::size_t idx = 0; idx < 2; ++idx) {
+                        LatestValue v {};
+                        if (!reader.read(idx, v)) continue;
+                        ++local_reads;
+                        if (!consistent(v)) torn.fetch_add(1, std::memory_order_relaxed);
+                        if (v.seq < last[idx]) backwards.fetch_add(1, std::memory_order_relaxed);
+                        last[idx] = v.seq;
+                    }
+                }
+                reads.fetch_add(local_reads);
+            });
+        }
+
+        const auto deadline = std::chrono::steady_clock::now() + kDuration;
+        std::uint64_t n = 1;
+        while (std::chrono::steady_clock::now() < deadline) {
+            for (int i = 0; i < 1000; ++i) {
+                ++n;
+                write(table, 0, n);
+                write(table, 1, n);
+            }
+        }
+        stop = true;
+        for (auto& t : readers) t.join();
+
+        CHECK_MSG(torn.load() == 0, "%llu torn reads out of %llu", static_cast<unsigned long long>(torn.load()),
+                  static_cast<unsigned long long>(reads.load()));
+        CHECK_MSG(backwards.load() == 0, "%llu reads went backwards", static_cast<unsigned long long>(backwards.load()));
+        CHECK_MSG(reads.load() > 0, "readers never got a value in %llu writes", static_cast<unsigned long long>(n));
+    }
+
+    void test_restart(const std::string& shm_name) {
+        LatestValueReader reader;
+        {
+            LatestValueTable table(shm_name, {metric("a", "")});
+            CHECK(table.open());
+            CHECK(reader.open(shm_name.c_str()));
+            CHECK(reader.generation() != 0 && !reader.stale());
+        }
+        CHECK_MSG(reader.stale(), "clean shutdown not noticed");
+
+        LatestValueTable old_writer(shm_name, {metric("a", "")});
+        CHECK(old_writer.open());
+        CHECK(reader.open(shm_name.c_str()) && !reader.stale());
+        write(old_writer, 0, 3);
+
+        // a restart after a crash: the old segment is unlinked but never retired
+        LatestValueTable new_writer(shm_name, {metric("a", ""), metric("b", "")});
+        CHECK(new_writer.open());
+        CHECK_MSG(reader.stale(), "reader did not notice the table was replaced");
+        LatestValue v {};
+        CHECK(reader.read(0, v) && v.seq == 3); // the old mapping stays readable
+
+        const auto old_generation = reader.generation();
+        CHECK(reader.open(shm_name.c_str()) && !reader.stale());
+        CHECK(reader.generation() != old_generation && reader.size() == 2);
+    }
+
+} // namespace
+
+int main() {
+    logger::set_level(logger::Level::Off);
+
+    const std::string shm_name = "/telemetry-latest-test-" + std::to_string(getpid());
+    test_layout(shm_name);
+    test_no_torn_reads(shm_name);
+    test_restart(shm_name);
+
+    return test::exit_code();
+}
@@ -0,0 +1,226 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <nlohmann/json.hpp>
+
+#include "check.h"
+#include "logger.h"
+#include "query_server.h"
+#include "time_series_store.h"
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+    using std::chrono::milliseconds;
+
+    constexpr std::int64_t kStartMs = 1699999980000; // minute-aligned
+
+    int connect_to(const std::string& path) {
+        const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        sockaddr_un addr {};
+        addr.sun_family = AF_UNIX;
+        std::memcpy(addr.sun_path, path.c_str(), path.size());
+        if (fd < 0 || ::connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0) {
+            std::perror("connect query socket");
+            if (fd >= 0) ::close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    bool send_str(int fd, const std::string& data) {
+        return ::send(fd, data.data(), data.size(), MSG_NOSIGNAL) == static_cast<ssize_t>(data.size());
+    }
+
+    // Splits a connection into response lines; bytes past a newline are kept for the next line.
+    class LineReader {
+        public:
+            explicit LineReader(int fd) : fd_(fd) {}
+
+            // nullopt on timeout or when the server closed the connection.
+            std::optional<std::string> read_line(milliseconds timeout) {
+                const auto deadline = Clock::now() + timeout;
+                for (;;) {
+                    if (const auto nl = buf_.find('\n'); nl != std::string::npos) {
+                        std::string line = buf_.substr(0, nl);
+                        buf_.erase(0, nl + 1);
+                        return line;
+                    }
+                    const auto left = std::chrono::duration_cast<milliseconds>(deadline - Clock::now()).count();
+                    if (left <= 0) return std::nullopt;
+                    pollfd pfd {fd_, POLLIN, 0};
+                    if (::poll(&pfd, 1, static_cast<int>(left)) <= 0) continue;
+                    char chunk[65536];
+                    const ssize_t n = ::recv(fd_, chunk, sizeof(chunk), 0);
+                    if (n <= 0) return std::nullopt;
+                    buf_.append(chunk, static_cast<std::size_t>(n));
+                }
+            }
+
+        private:
+            int fd_;
+            std::string buf_;
+    };
+
+    // True once the server has closed `fd`.
+    bool closed_by_server(int fd) {
+        pollfd pfd {fd, POLLIN, 0};
+        if (::poll(&pfd, 1, 0) <= 0) return false;
+        char c;
+        return ::recv(fd, &c, 1, MSG_DONTWAIT) == 0;
+    }
+
+    // generous: a loaded CI host can take a while to encode and deliver a 100 KB response
+    constexpr milliseconds kReplyTimeout {5000};
+
+    nlohmann::json query(int fd, LineReader& reader, const nlohmann::json& request) {
+        if (!send_str(fd, request.dump() + "\n")) return {};
+        const auto line = reader.read_line(kReplyTimeout);
+        return line ? nlohmann::json::parse(*line, nullptr, false) : nlohmann::json {};
+    }
+
+    nlohmann::json query(int fd, const nlohmann::json& request) {
+        LineReader reader(fd);
+        return query(fd, reader, request);
+    }
+
+    void test_queries(const std::string& path) {
+        const int fd = connect_to(path);
+        CHECK(fd >= 0);
+        if (fd < 0) return;
+        LineReader reader(fd);
+
+        const auto latest = query(fd, reader, {{"op", "latest"}, {"metric", "temperature"}});
+        CHECK(latest.value("t_ms", std::int64_t{0}) == kStartMs + 3599 * 1000);
+
+        const auto range = query(fd, reader, {{"op", "range"}, {"metric", "temperature"}});
+        CHECK(range.contains("points") && range["points"].size() == 3600);
+
+        const auto down = query(fd, reader, {{"op", "downsample"}, {"metric", "temperature"}, {"step_ms", 60000}});
+        CHECK(down.contains("buckets") && down["buckets"].size() == 60);
+
+        const auto unknown = query(fd, reader, {{"op", "range"}, {"metric", "nope"}});
+        CHECK(unknown.contains("error"));
+        ::close(fd);
+    }
+
+    // `echo '{...}' | socat - UNIX-CONNECT:...` shuts down its write side before reading.
+    void test_half_close(const std::string& path) {
+        const int fd = connect_to(path);
+        if (fd < 0) return;
+        CHECK(send_str(fd, "{\"op\":\"metrics\"}\n"));
+        ::shutdown(fd, SHUT_WR);
+        const auto line = LineReader(fd).read_line(kReplyTimeout);
+        CHECK_MSG(line && nlohmann::json::parse(*line).contains("metrics"), "no response after half-close");
+        ::close(fd);
+    }
+
+    // A client that trickles bytes without ever finishing a request must neither block other
+    // clients nor keep its connection past the request timeout.
+    void test_slow_client(const std::string& path) {
+        const int slow = connect_to(path);
+        if (slow < 0) return;
+        CHECK(send_str(slow, "{\"op\":"));
+
+        const auto t0 = Clock::now();
+        const int fast = connect_to(path);
+        if (fast >= 0) {
+            const auto resp = query(fast, {{"op", "metrics"}});
+            const auto waited = std::chrono::duration_cast<milliseconds>(Clock::now() - t0).count();
+            CHECK_MSG(resp.contains("metrics"), "second client not served while the first is mid-request");
+            CHECK_MSG(waited < 500, "second client waited %lld ms", static_cast<long long>(waited));
+            ::close(fast);
+        }
+
+        bool closed = false;
+        const auto limit = t0 + QueryServer::kRequestTimeout + milliseconds(1000);
+        while (!closed && Clock::now() < limit) {
+            (void)send_str(slow, " ");
+            std::this_thread::sleep_for(milliseconds(100));
+            closed = closed_by_server(slow);
+        }
+        const auto held = std::chrono::duration_cast<milliseconds>(Clock::now() - t0).count();
+        CHECK_MSG(closed, "trickling client still connected after %lld ms", static_cast<long long>(held));
+        ::close(slow);
+    }
+
+    // A response far larger than the socket buffers, read slowly for longer than kRequestTimeout,
+    // must still arrive complete.
+    void test_slow_reader(const std::string& path, std::size_t points) {
+        const int fd = connect_to(path);
+        if (fd < 0) return;
+        CHECK(send_str(fd, "{\"op\":\"range\",\"metric\":\"pressure\"}\n"));
+
+        std::string reply;
+        const auto t0 = Clock::now();
+        const auto limit = t0 + QueryServer::kRequestTimeout * 3;
+        while (Clock::now() < limit && (reply.empty() || reply.back() != '\n')) {
+            std::this_thread::sleep_for(milliseconds(250));
+            char chunk[16384];
+            const ssize_t n = ::recv(fd, chunk, sizeof(chunk), MSG_DONTWAIT);
+            if (n == 0) break;
+            if (n > 0) reply.append(chunk, static_cast<std::size_t>(n));
+        }
+        const auto took = std::chrono::duration_cast<milliseconds>(Clock::now() - t0).count();
+        ::close(fd);
+
+        CHECK_MSG(took > std::chrono::duration_cast<milliseconds>(QueryServer::kRequestTimeout).count(),
+                  "reply of %zu bytes arrived in %lld ms, before the request timeout", reply.size(), static_cast<long long>(took));
+        const auto resp = nlohmann::json::parse(reply, nullptr, false);
+        CHECK_MSG(!resp.is_discarded() && resp.contains("points") && resp["points"].size() == points,
+                  "got %zu bytes of a range reply after %lld ms", reply.size(), static_cast<long long>(took));
+    }
+
+    void test_client_limit(const std::string& path) {
+        std::vector<int> fds;
+        for (std::size_t i = 0; i < QueryServer::kMaxClients; ++i) fds.push_back(connect_to(path));
+
+        // the server accepts and immediately closes one more
+        const int extra = connect_to(path);
+        CHECK(extra >= 0);
+        CHECK(!LineReader(extra).read_line(milliseconds(500)));
+        ::close(extra);
+
+        CHECK(query(fds.front(), {{"op", "metrics"}}).contains("metrics"));
+        for (const int fd : fds) ::close(fd);
+    }
+
+} // namespace
+
+int main() {
+    logger::set_level(logger::Level::Off);
+
+    // pressure is the full 6 h at 1 Hz: about 0.9 MB of JSON in one range reply
+    constexpr std::size_t kPressurePoints = 6 * 3600;
+    TimeSeriesStore store({"temperature", "humidity", "pressure"}, std::chrono::hours(6));
+    for (std::int64_t i = 0; i < 3600; ++i) {
+        store.append(0, kStartMs + i * 1000, 20.0 + 0.01 * static_cast<double>(i % 100));
+        store.append(1, kStartMs + i * 1000, 45.0);
+    }
+    for (std::size_t i = 0; i < kPressurePoints; ++i) {
+        store.append(2, kStartMs + static_cast<std::int64_t>(i) * 1000, 1013.25 + 0.001 * static_cast<double>(i));
+    }
+
+    const std::string path = "/tmp/telemetry-query-test-" + std::to_string(getpid()) + ".sock";
+    QueryServer server(store, path);
+    CHECK(server.start());
+
+    test_queries(path);
+    test_half_close(path);
+    test_slow_client(path);
+    test_slow_reader(path, kPressurePoints);
+    test_client_limit(path);
+
+    server.stop();
+    CHECK(server.queries() > 0);
+    return test::exit_code();
+}
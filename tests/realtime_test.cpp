@@ -0,0 +1,83 @@
+#include <alloca.h>
+#include <cstddef>
+#include <cstdio>
+#include <pthread.h>
+#include <sys/resource.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "check.h"
+#include "logger.h"
+#include "realtime.h"
+
+namespace {
+
+    long minor_faults() {
+        rusage usage {};
+        getrusage(RUSAGE_SELF, &usage);
+        return usage.ru_minflt;
+    }
+
+    // Touches `bytes` of stack below this frame and returns the minor faults it took.
+    __attribute__((noinline)) long touch_stack(std::size_t bytes) {
+        const long before = minor_faults();
+        auto* block = static_cast<volatile unsigned char*>(alloca(bytes));
+        for (std::size_t i = bytes; i >= 4096; i -= 4096) block[i - 1] = 1;
+        return minor_faults() - before;
+    }
+
+    void test_affinity_round_trip() {
+        const auto original = get_thread_affinity();
+        CHECK(!original.empty());
+        if (original.size() < 2) {
+            std::printf("realtime_test: single CPU, skipping affinity round trip\n");
+            return;
+        }
+
+        CHECK(set_thread_affinity({original.front()}));
+        CHECK(get_thread_affinity() == std::vector<int> {original.front()});
+
+        CHECK(set_thread_affinity(original));
+        CHECK(get_thread_affinity() == original);
+    }
+
+    // std::thread passes no attributes, like libmosquitto's loop thread, so it gets the default
+    void test_default_thread_stack() {
+        CHECK(set_default_thread_stack(256));
+
+        std::size_t stack = 0;
+        std::thread([&stack] {
+            pthread_attr_t attr;
+            if (pthread_getattr_np(pthread_self(), &attr) == 0) {
+                pthread_attr_getstacksize(&attr, &stack);
+                pthread_attr_destroy(&attr);
+            }
+        }).join();
+        CHECK_MSG(stack >= 256 * 1024 && stack < 512 * 1024, "new thread got a %zu KiB stack", stack / 1024);
+    }
+
+    void test_stack_prefault() {
+        constexpr std::size_t kPrefaultKb = 2048;
+        constexpr std::size_t kTouchBytes = 1536 * 1024;
+
+        if (!lock_and_prefault_memory(0, kPrefaultKb)) {
+            std::printf("realtime_test: mlockall not permitted, skipping stack prefault\n");
+            return;
+        }
+        // far more than 64 KiB deep: every page should already be resident
+        const long faults = touch_stack(kTouchBytes);
+        CHECK_MSG(faults < 16, "%ld minor faults touching %zu KiB of prefaulted stack", faults, kTouchBytes / 1024);
+    }
+
+} // namespace
+
+int main() {
+    logger::set_level(logger::Level::Off);
+
+    test_affinity_round_trip();
+    test_default_thread_stack();
+    test_stack_prefault();
+
+    return test::exit_code();
+}
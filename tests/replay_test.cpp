@@ -0,0 +1,206 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "app_config.h"
+#include "check.h"
+#include "logger.h"
+#include "recorder.h"
+#include "replay_sensor.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+    using std::chrono::milliseconds;
+
+    MetricConfig metric(const std::string& name, const std::string& type = "simulated") {
+        MetricConfig m;
+        m.name = name;
+        m.type = type;
+        m.topic_suffix = name;
+        return m;
+    }
+
+    RecordConfig record_config(const fs::path& dir, int max_file_kb = 65536, int max_files = 0) {
+        RecordConfig cfg;
+        cfg.enabled = true;
+        cfg.directory = dir;
+        cfg.max_file_kb = max_file_kb;
+        cfg.max_files = max_files;
+        return cfg;
+    }
+
+    // <stem>-yyyymmddThhmmssZ-nnn.rec in dir, oldest first
+    std::vector<fs::path> recordings(const fs::path& dir, const std::string& stem) {
+        std::vector<fs::path> out;
+        for (const auto& entry : fs::directory_iterator(dir)) {
+            const std::string name = entry.path().filename().string();
+            if (name.size() == stem.size() + 25 && name.compare(0, stem.size() + 1, stem + "-") == 0) out.push_back(entry.path());
+        }
+        std::sort(out.begin(), out.end());
+        return out;
+    }
+
+    std::size_t record_count(const fs::path& file) {
+        return (fs::file_size(file) - sizeof(replay_format::Header)) / sizeof(replay_format::Record);
+    }
+
+    void test_file_names(const fs::path& dir) {
+        {
+            Recorder recorder(record_config(dir), {metric("temperature"), metric("../escape"), metric("a/b c"), metric("vibration", "waveform")});
+        }
+        CHECK(recordings(dir, "temperature").size() == 1);
+        CHECK(recordings(dir, "_.._escape").size() == 1);
+        CHECK(recordings(dir, "a_b_c").size() == 1);
+        CHECK(recordings(dir.parent_path(), "escape").empty());
+        CHECK_MSG(recordings(dir, "vibration").empty(), "waveform metric got an empty recording");
+
+        bool threw = false;
+        try {
+            Recorder recorder(record_config(dir), {metric("a/b"), metric("a_b")});
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        CHECK_MSG(threw, "two metrics mapping to one recording were accepted");
+    }
+
+    // Records `count` values 1 ms apart and returns the file path.
+    fs::path record(const fs::path& dir, int count, int max_files = 0) {
+        {
+            const auto t0 = Clock::now();
+            Recorder recorder(record_config(dir, 65536, max_files), {metric("level")});
+            for (int i = 0; i < count; ++i) recorder.append(0, t0 + milliseconds(i), static_cast<double>(i));
+        }
+        return recordings(dir, "level").back();
+    }
+
+    // Drains like run_loop does: sample() until nothing more is due this iteration.
+    void drain(ReplaySensor& sensor, std::vector<double>& out) {
+        for (;;) {
+            const auto reading = sensor.sample();
+            if (!reading) return;
+            out.push_back(reading->value);
+            if (!sensor.has_pending()) return;
+        }
+    }
+
+    void test_fast_replay(const fs::path& dir) {
+        constexpr int kCount = 2000;
+        ReplaySensor sensor("level", "", record(dir, kCount), 20.0, /*loop*/ false);
+        CHECK(sensor.init());
+
+        // 2 s of 1 kHz data at 20x takes 100 ms; a 10 ms loop has ~200 records due per iteration
+        std::vector<double> values;
+        int iterations = 0;
+        const auto deadline = Clock::now() + milliseconds(2000);
+        while (values.size() < kCount && Clock::now() < deadline) {
+            drain(sensor, values);
+            ++iterations;
+            std::this_thread::sleep_for(milliseconds(10));
+        }
+
+        CHECK_MSG(values.size() == kCount, "replayed %zu of %d records", values.size(), kCount);
+        CHECK_MSG(iterations < 40, "took %d loop iterations", iterations);
+        bool in_order = true;
+        for (std::size_t i = 0; i < values.size(); ++i) in_order = in_order && values[i] == static_cast<double>(i);
+        CHECK_MSG(in_order, "records skipped or reordered");
+        CHECK(!sensor.sample());
+    }
+
+    void test_loop_wraps_once_per_iteration(const fs::path& dir) {
+        ReplaySensor sensor("level", "", record(dir, 1), 1.0, /*loop*/ true);
+        CHECK(sensor.init());
+
+        std::vector<double> values;
+        drain(sensor, values);
+        drain(sensor, values);
+        CHECK(values.size() == 2);
+    }
+
+    void test_speed_zero(const fs::path& dir) {
+        ReplaySensor sensor("level", "", record(dir, 3), 0.0, /*loop*/ false);
+        CHECK(sensor.init());
+
+        std::vector<double> values;
+        drain(sensor, values);
+        CHECK(values.size() == 1);
+        drain(sensor, values);
+        drain(sensor, values);
+        drain(sensor, values);
+        CHECK(values == (std::vector<double> {0.0, 1.0, 2.0}));
+    }
+
+    // A replay mapped from the recording directory while the recorder runs there again, as after a
+    // restart with both record and replay configured: neither the mapped file nor the earlier run's
+    // recording may be truncated.
+    void test_replay_and_record_same_directory(const fs::path& dir) {
+        const fs::path earlier = record(dir, 100);
+        ReplaySensor sensor("level", "", earlier, 0.0, /*loop*/ false);
+        CHECK(sensor.init());
+
+        const fs::path latest = record(dir, 5000);
+        CHECK(latest != earlier);
+        CHECK_MSG(record_count(earlier) == 100, "earlier recording holds %zu records", record_count(earlier));
+        CHECK(record_count(latest) == 5000);
+
+        std::vector<double> values;
+        for (int i = 0; i < 200; ++i) drain(sensor, values);
+        bool in_order = values.size() == 100;
+        for (std::size_t i = 0; in_order && i < values.size(); ++i) in_order = values[i] == static_cast<double>(i);
+        CHECK_MSG(in_order, "replayed %zu records from the mapped file", values.size());
+    }
+
+    void test_rotation(const fs::path& dir) {
+        // 1 KiB files hold the header and 63 records
+        {
+            const auto t0 = Clock::now();
+            Recorder recorder(record_config(dir, 1, 3), {metric("level")});
+            for (int i = 0; i < 200; ++i) recorder.append(0, t0 + milliseconds(i), static_cast<double>(i));
+        }
+        const auto files = recordings(dir, "level");
+        CHECK_MSG(files.size() == 3, "kept %zu files", files.size());
+        std::size_t records = 0;
+        for (const auto& f : files) {
+            CHECK(fs::file_size(f) <= 1024);
+            records += record_count(f);
+        }
+        CHECK_MSG(records == 200 - 63, "kept %zu records", records);
+
+        // the oldest file is unlinked while a replay has it mapped
+        ReplaySensor sensor("level", "", record(dir, 10, 1), 0.0, /*loop*/ false);
+        CHECK(sensor.init());
+        record(dir, 10, 1);
+        CHECK(recordings(dir, "level").size() == 1);
+        std::vector<double> values;
+        for (int i = 0; i < 20; ++i) drain(sensor, values);
+        CHECK(values.size() == 10);
+    }
+
+} // namespace
+
+int main() {
+    logger::set_level(logger::Level::Off);
+
+    const fs::path base = fs::temp_directory_path() / ("telemetry-replay-test-" + std::to_string(getpid()));
+    const fs::path dir = base / "recordings";
+    fs::create_directories(dir);
+
+    test_file_names(dir);
+    test_fast_replay(dir);
+    test_loop_wraps_once_per_iteration(dir);
+    test_speed_zero(dir);
+    test_replay_and_record_same_directory(dir);
+    fs::create_directories(base / "rotation");
+    test_rotation(base / "rotation");
+
+    fs::remove_all(base);
+    return test::exit_code();
+}
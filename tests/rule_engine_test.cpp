@@ -0,0 +1,155 @@
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "app_config.h"
+#include "check.h"
+#include "rule_engine.h"
+
+// RuleEngine::evaluate with explicit timestamps: for_ms holds, rate rules, band rules with a
+// second metric, and exactly one event per transition.
+
+namespace {
+
+    using Clock = RuleEngine::Clock;
+    using std::chrono::milliseconds;
+
+    // pending_since uses the epoch as "not pending", so stay well clear of it
+    const Clock::time_point t0 = Clock::time_point {} + std::chrono::hours(1);
+
+    constexpr std::size_t kTemperature = 0;
+    constexpr std::size_t kHumidity = 1;
+
+    std::vector<MetricConfig> metrics() {
+        std::vector<MetricConfig> out(2);
+        out[kTemperature].name = "temperature";
+        out[kHumidity].name = "humidity";
+        return out;
+    }
+
+    RuleConfig threshold(const std::string& op, double value, int for_ms = 0) {
+        RuleConfig r;
+        r.name = "threshold";
+        r.metric = "temperature";
+        r.op = op;
+        r.value = value;
+        r.for_ms = for_ms;
+        return r;
+    }
+
+    // Events from one sample; also checks that the return value matches what was appended.
+    std::vector<RuleEvent> feed(RuleEngine& engine, std::size_t metric, double value, Clock::time_point t) {
+        std::vector<RuleEvent> out;
+        const std::size_t n = engine.evaluate(metric, value, t, out);
+        CHECK(n == out.size());
+        return out;
+    }
+
+    bool is(const std::vector<RuleEvent>& events, std::string_view state) {
+        return events.size() == 1 && events[0].state == state;
+    }
+
+    void test_hold() {
+        RuleEngine engine({threshold(">", 80.0, 1000)}, metrics());
+
+        CHECK(feed(engine, kTemperature, 85.0, t0).empty());
+        CHECK(feed(engine, kTemperature, 85.0, t0 + milliseconds(500)).empty());
+        CHECK_MSG(feed(engine, kTemperature, 85.0, t0 + milliseconds(999)).empty(), "fired before the hold elapsed");
+        CHECK(is(feed(engine, kTemperature, 85.0, t0 + milliseconds(1000)), "fired"));
+        CHECK_MSG(feed(engine, kTemperature, 85.0, t0 + milliseconds(1500)).empty(), "fired twice");
+        CHECK(is(feed(engine, kTemperature, 70.0, t0 + milliseconds(2000)), "cleared"));
+
+        // dropping below the threshold before the hold elapses restarts it and emits nothing
+        CHECK(feed(engine, kTemperature, 85.0, t0 + milliseconds(3000)).empty());
+        CHECK_MSG(feed(engine, kTemperature, 70.0, t0 + milliseconds(3900)).empty(), "cleared a rule that never fired");
+        CHECK(feed(engine, kTemperature, 85.0, t0 + milliseconds(4000)).empty());
+        CHECK_MSG(feed(engine, kTemperature, 85.0, t0 + milliseconds(4900)).empty(), "hold did not restart");
+        CHECK(is(feed(engine, kTemperature, 85.0, t0 + milliseconds(5000)), "fired"));
+    }
+
+    void test_rate() {
+        RuleConfig rule = threshold(">", 10.0); // units per second
+        rule.kind = "rate";
+        RuleEngine engine({rule}, metrics());
+
+        CHECK_MSG(feed(engine, kTemperature, 0.0, t0).empty(), "fired without a previous sample");
+        CHECK(feed(engine, kTemperature, 0.5, t0 + milliseconds(100)).empty()); // 5/s
+        CHECK(is(feed(engine, kTemperature, 2.5, t0 + milliseconds(200)), "fired")); // 20/s
+
+        // other metrics neither advance nor reset the rate
+        CHECK(feed(engine, kHumidity, 99.0, t0 + milliseconds(250)).empty());
+        CHECK(feed(engine, kTemperature, 4.5, t0 + milliseconds(300)).empty()); // 20/s, still active
+        CHECK(is(feed(engine, kTemperature, 4.6, t0 + milliseconds(400)), "cleared")); // 1/s
+
+        // a fall is a negative rate
+        CHECK(feed(engine, kTemperature, 0.0, t0 + milliseconds(500)).empty());
+    }
+
+    void test_band_with() {
+        RuleConfig rule;
+        rule.name = "damp_and_hot";
+        rule.kind = "band";
+        rule.metric = "temperature";
+        rule.low = 10.0;
+        rule.high = 30.0;
+        rule.with_metric = "humidity";
+        rule.with_low = 20.0;
+        rule.with_high = 60.0;
+        RuleEngine engine({rule}, metrics());
+
+        CHECK_MSG(feed(engine, kTemperature, 35.0, t0).empty(), "fired before the second metric was seen");
+        CHECK(feed(engine, kHumidity, 50.0, t0 + milliseconds(100)).empty());
+
+        // the second metric completes the condition; the event still reports both metrics
+        const auto fired = feed(engine, kHumidity, 70.0, t0 + milliseconds(200));
+        CHECK(is(fired, "fired"));
+        if (fired.size() == 1) {
+            CHECK(fired[0].metric == "temperature" && fired[0].value == 35.0);
+            CHECK(fired[0].with_metric == "humidity" && fired[0].with_value == 70.0);
+        }
+
+        CHECK(feed(engine, kTemperature, 36.0, t0 + milliseconds(300)).empty());
+        CHECK(is(feed(engine, kTemperature, 25.0, t0 + milliseconds(400)), "cleared"));
+        CHECK(feed(engine, kHumidity, 80.0, t0 + milliseconds(500)).empty());
+        CHECK(is(feed(engine, kTemperature, 5.0, t0 + milliseconds(600)), "fired")); // below the band
+    }
+
+    void test_one_event_per_transition() {
+        RuleEngine engine({threshold(">=", 50.0)}, metrics());
+
+        // runs of different lengths on both sides of the threshold, including the edge value
+        const std::vector<double> values = {10, 50, 50, 60, 49, 49.9, 10, 50, 20, 70, 70, 70, 0, 50, 49, 51, 0, 0};
+        bool above = false;
+        int transitions = 0;
+        int events = 0;
+        std::string_view last = "cleared";
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            const auto out = feed(engine, kTemperature, values[i], t0 + milliseconds(100 * static_cast<int>(i)));
+            const bool now_above = values[i] >= 50.0;
+            if (now_above != above) {
+                ++transitions;
+                CHECK_MSG(is(out, now_above ? "fired" : "cleared"), "sample %zu (%g): %zu events", i, values[i], out.size());
+            } else {
+                CHECK_MSG(out.empty(), "sample %zu (%g): event without a transition", i, values[i]);
+            }
+            for (const auto& e : out) {
+                CHECK_MSG(e.state != last, "two '%.*s' events in a row", static_cast<int>(e.state.size()), e.state.data());
+                last = e.state;
+                ++events;
+            }
+            above = now_above;
+        }
+        CHECK(events == transitions);
+    }
+
+} // namespace
+
+int main() {
+    test_hold();
+    test_rate();
+    test_band_with();
+    test_one_event_per_transition();
+
+    return test::exit_code();
+}
@@ -0,0 +1,380 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "app_config.h"
+#include "check.h"
+#include "daemon_loop.h"
+#include "fake_broker.h"
+#include "logger.h"
+#include "mqtt_client.h"
+#include "proc_stats.h"
+#include "rule_engine.h"
+#include "systemd_notify.h"
+#include "topic_builder.h"
+
+// Soak / fault-injection run of the real sampling loop and MqttClient against the scripted
+// broker in fake_mosquitto.cpp, with the loop and reconnect backoff accelerated.
+//
+//   soak                       short run for CI (ctest: soak_short)
+//   soak --duration-s 14400    multi-hour run (cmake --build . --target soak_long)
+//
+// Each cycle injects client-side drops, broker drops, refused TCP connects, refused CONNACKs
+// and slow CONNACKs. The run fails if the client does not recover, if tick_reconnect_ retries
+// sooner or much later than its backoff allows or does not reset it, if rule events are lost
+// or reordered, or if RSS keeps growing after warmup. Reconnects made by libmosquitto's own
+// loop thread are counted and reported, not timed.
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+    using std::chrono::milliseconds;
+
+    struct Options {
+        double duration_s = 20.0;
+        int interval_ms = 2;
+        std::int64_t max_rss_growth_kb = 1024;
+    };
+
+    Options parse_options(int argc, char** argv) {
+        Options opts;
+        for (int i = 1; i + 1 < argc; i += 2) {
+            const std::string arg = argv[i];
+            const char* value = argv[i + 1];
+            if (arg == "--duration-s") opts.duration_s = std::atof(value);
+            else if (arg == "--interval-ms") opts.interval_ms = std::atoi(value);
+            else if (arg == "--max-rss-growth-kb") opts.max_rss_growth_kb = std::atoll(value);
+            else {
+                std::fprintf(stderr, "usage: soak [--duration-s N] [--interval-ms N] [--max-rss-growth-kb N]\n");
+                std::exit(2);
+            }
+        }
+        return opts;
+    }
+
+    // Accelerated reconnect timing; all scenario expectations are derived from these.
+    const MqttReconnectOptions kReconnect {milliseconds(20), milliseconds(160)};
+
+    // libmosquitto's default reconnect_delay; its loop thread retries on its own at this pace
+    constexpr milliseconds kLibraryReconnectDelay {1000};
+
+    // Upper tolerance on retry timing: one 2 ms loop period plus scheduling noise.
+    constexpr milliseconds kSlack {250};
+
+    // Sweeps 0..100 and back so the threshold rule fires and clears every few hundred samples.
+    class TriangleSensor final : public ISensor {
+        public:
+            bool init() override { return true; }
+            std::optional<Reading> sample() override {
+                value_ += step_;
+                if (value_ >= 100.0 || value_ <= 0.0) step_ = -step_;
+                return Reading {"level", "%", value_};
+            }
+            std::string_view name() const override { return "level"; }
+
+        private:
+            double value_ = 0.0;
+            double step_ = 1.0;
+    };
+
+    // What the broker saw, fed by the fake broker's publish hook.
+    struct Observer {
+        std::mutex mtx;
+        std::uint64_t telemetry = 0;
+        std::uint64_t snippets = 0;
+        std::uint64_t events = 0;
+        std::uint64_t event_order_errors = 0;
+        std::map<std::string, std::string> last_event_state; // rule -> fired | cleared
+        std::string last_health;
+        std::string last_status_state;
+
+        std::string telemetry_topic;
+        std::string snippet_topic;
+        std::string events_topic;
+        std::string health_topic;
+        std::string status_topic;
+
+        void on_publish(std::string_view topic, std::string_view payload) {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (topic == telemetry_topic) {
+                ++telemetry;
+            } else if (topic == snippet_topic) {
+                ++snippets;
+            } else if (topic == events_topic) {
+                ++events;
+                const auto event = nlohmann::json::parse(payload);
+                const auto rule = event.at("rule").get<std::string>();
+                const auto state = event.at("state").get<std::string>();
+                auto& last = last_event_state[rule];
+                // a rule's events must alternate, starting with "fired"
+                const bool ok = last.empty() ? state == "fired" : state != last;
+                if (!ok) ++event_order_errors;
+                last = state;
+            } else if (topic == health_topic) {
+                last_health.assign(payload);
+            } else if (topic == status_topic) {
+                last_status_state = nlohmann::json::parse(payload).at("state").get<std::string>();
+            }
+        }
+
+        std::uint64_t telemetry_count() {
+            std::lock_guard<std::mutex> lock(mtx);
+            return telemetry;
+        }
+    };
+
+    bool wait_for(const std::function<bool()>& cond, milliseconds timeout) {
+        const auto deadline = Clock::now() + timeout;
+        while (Clock::now() < deadline) {
+            if (cond()) return true;
+            std::this_thread::sleep_for(milliseconds(2));
+        }
+        return cond();
+    }
+
+    double ms_between(Clock::time_point a, Clock::time_point b) {
+        return std::chrono::duration<double, std::milli>(b - a).count();
+    }
+
+    struct Scenario {
+        const char* name;
+        std::function<void(MqttClient&)> inject;
+        int failures = 0; // connect attempts the broker refuses or holds back
+    };
+
+    std::vector<Scenario> make_scenarios() {
+        return {
+            {"client drop", [](MqttClient& mqtt) { mqtt.drop_connection(); }},
+            {"broker drop", [](MqttClient&) { fake_broker::drop(); }},
+            {"refused connects", [](MqttClient&) { fake_broker::refuse_tcp(3); fake_broker::drop(); }, 3},
+            {"refused CONNACKs", [](MqttClient&) { fake_broker::refuse_connack(4); fake_broker::drop(); }, 4},
+            {"slow CONNACK", [](MqttClient&) { fake_broker::delay_connack(milliseconds(100)); fake_broker::drop(); }, 1},
+            {"CONNACK held back", [](MqttClient&) { fake_broker::delay_connack(milliseconds(400)); fake_broker::drop(); }, 1},
+            {"refusal storm past the backoff cap", [](MqttClient&) { fake_broker::refuse_tcp(2); fake_broker::refuse_connack(5); fake_broker::drop(); }, 7},
+        };
+    }
+
+    // tick_reconnect_'s schedule: the first attempt right after the loss, then one every
+    // min_backoff * 2^n (capped) for as long as the client is not connected.
+    void check_attempts(const Scenario& sc, const std::vector<fake_broker::Attempt>& attempts, Clock::time_point lost_at) {
+        std::vector<Clock::time_point> ticks;
+        for (const auto& a : attempts) {
+            if (a.origin == fake_broker::Origin::Client) ticks.push_back(a.at);
+        }
+        CHECK_MSG(!ticks.empty(), "%s: tick_reconnect_ never tried to reconnect", sc.name);
+        if (ticks.empty()) return;
+
+        const double first_ms = ms_between(lost_at, ticks.front());
+        CHECK_MSG(first_ms <= static_cast<double>(kSlack.count()), "%s: first retry after %.1f ms", sc.name, first_ms);
+
+        auto backoff = kReconnect.min_backoff;
+        for (std::size_t i = 1; i < ticks.size(); ++i) {
+            const double gap_ms = ms_between(ticks[i - 1], ticks[i]);
+            const auto expect_ms = static_cast<double>(backoff.count());
+            CHECK_MSG(gap_ms >= expect_ms * 0.95 - 1.0, "%s: retry %zu after %.1f ms, backoff is %.0f ms", sc.name, i, gap_ms, expect_ms);
+            CHECK_MSG(gap_ms <= expect_ms + static_cast<double>(kSlack.count()), "%s: retry %zu after %.1f ms, backoff is %.0f ms", sc.name, i, gap_ms, expect_ms);
+            backoff = std::min(backoff * 2, kReconnect.max_backoff);
+        }
+    }
+
+    // Generous time for a scenario to recover, used as its timeout: one backoff step per
+    // failed attempt, plus the library's own reconnect delay.
+    milliseconds recovery_budget(const Scenario& sc) {
+        auto total = kLibraryReconnectDelay + kSlack * 2;
+        auto backoff = kReconnect.min_backoff;
+        for (int i = 0; i <= sc.failures; ++i) {
+            total += backoff + kSlack;
+            backoff = std::min(backoff * 2, kReconnect.max_backoff);
+        }
+        return total;
+    }
+
+    AppConfig make_config(const Options& opts) {
+        AppConfig cfg;
+        cfg.client_id = "soak";
+        cfg.interval_ms = opts.interval_ms;
+        cfg.qos = 1;
+
+        MetricConfig level;
+        level.name = "level";
+        level.unit = "%";
+        level.topic_suffix = "level";
+        cfg.metrics.push_back(level);
+
+        MetricConfig vibration;
+        vibration.name = "vibration";
+        vibration.unit = "g";
+        vibration.topic_suffix = "vibration";
+        vibration.type = "waveform";
+        vibration.waveform.sample_rate_hz = 8000;
+        vibration.waveform.block_size = 256;
+        vibration.waveform.bands = {{0.0, 100.0}, {100.0, 1000.0}};
+        vibration.waveform.snippet_len = 64;
+        vibration.waveform.noise = 0.1;
+        cfg.metrics.push_back(vibration);
+
+        RuleConfig high;
+        high.name = "level_high";
+        high.metric = "level";
+        high.op = ">";
+        high.value = 70.0;
+        cfg.rules.push_back(high);
+
+        RuleConfig band;
+        band.name = "level_band";
+        band.kind = "band";
+        band.metric = "level";
+        band.low = 20.0;
+        band.high = 80.0;
+        band.for_ms = 20;
+        cfg.rules.push_back(band);
+        return cfg;
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const Options opts = parse_options(argc, argv);
+    logger::set_level(logger::Level::Off);
+    ::unsetenv("NOTIFY_SOCKET");
+
+    const AppConfig cfg = make_config(opts);
+
+    Observer observer;
+    observer.telemetry_topic = make_topic(cfg.client_id, "level");
+    observer.snippet_topic = make_subtopic(cfg.client_id, "vibration", "raw");
+    observer.events_topic = make_events_topic(cfg.client_id);
+    observer.health_topic = make_health_topic(cfg.client_id);
+    observer.status_topic = make_status_topic(cfg.client_id);
+    fake_broker::set_publish_hook([&observer](std::string_view topic, std::string_view payload, bool) {
+        observer.on_publish(topic, payload);
+    });
+
+    std::vector<SensorEntry> sensors;
+    sensors.push_back(SensorEntry {make_topic(cfg.client_id, "level"), std::make_unique<TriangleSensor>(), 0});
+    auto waveforms = build_waveforms(cfg);
+    RuleEngine rules(cfg.rules, cfg.metrics);
+    SystemdNotifier notifier;
+
+    MqttClient mqtt("soak-broker", 1883, cfg.client_id, cfg.qos);
+    mqtt.set_reconnect_options(kReconnect);
+    subscribe_snippet_requests(mqtt, cfg, waveforms);
+    CHECK(mqtt.connect(5));
+    CHECK(wait_for([&] { return mqtt.connected(); }, milliseconds(1000)));
+
+    for (auto& entry : waveforms) CHECK(entry.channel->start());
+
+    std::atomic<bool> running {true};
+    Pipeline pipeline {rules, notifier, waveforms};
+    std::thread loop([&] { run_loop(mqtt, cfg, sensors, pipeline, running); });
+
+    const auto scenarios = make_scenarios();
+    const auto start = Clock::now();
+    const auto end = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(opts.duration_s));
+    const auto warmup_end = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(std::max(3.0, opts.duration_s * 0.2)));
+
+    std::vector<std::uint64_t> rss_kb; // sampled once per scenario after warmup
+    std::uint64_t cycles = 0;
+    std::uint64_t faults = 0;
+
+    while (Clock::now() < end && test::failures() == 0) {
+        for (const auto& sc : scenarios) {
+            if (Clock::now() >= end) break;
+
+            (void)fake_broker::take_attempts();
+            const auto lwt_before = fake_broker::counters().lwt_published;
+
+            sc.inject(mqtt);
+            ++faults;
+
+            // the drop is seen first, then the client works through its retries
+            CHECK_MSG(wait_for([&] { return fake_broker::counters().lwt_published > lwt_before; }, kSlack),
+                      "%s: connection was not dropped uncleanly", sc.name);
+            const auto lost_at = fake_broker::last_loss();
+
+            // connected() can still report the old session right after the drop, so recovery
+            // means an accepted attempt since the drop plus a connected client
+            std::vector<fake_broker::Attempt> attempts;
+            const bool recovered = wait_for([&] {
+                const auto more = fake_broker::take_attempts();
+                attempts.insert(attempts.end(), more.begin(), more.end());
+                return !attempts.empty() && attempts.back().outcome == fake_broker::Outcome::Accepted && mqtt.connected();
+            }, recovery_budget(sc));
+            CHECK_MSG(recovered, "%s: not reconnected within %lld ms", sc.name, static_cast<long long>(recovery_budget(sc).count()));
+            if (!recovered) break;
+
+            check_attempts(sc, attempts, lost_at);
+            CHECK_MSG(mqtt.backoff_ms() == kReconnect.min_backoff.count(), "%s: backoff not reset (%lld ms)", sc.name,
+                      static_cast<long long>(mqtt.backoff_ms()));
+
+            // telemetry flows again, and subscriptions were re-issued
+            const auto published = observer.telemetry_count();
+            CHECK_MSG(wait_for([&] { return observer.telemetry_count() >= published + 10; }, milliseconds(1000)),
+                      "%s: telemetry did not resume", sc.name);
+            fake_broker::inject_message(make_subtopic(cfg.client_id, "vibration", "snippet_request"), "");
+
+            std::this_thread::sleep_for(milliseconds(100));
+            if (Clock::now() >= warmup_end) rss_kb.push_back(read_rss_kb());
+        }
+        ++cycles;
+    }
+
+    running.store(false);
+    loop.join();
+    mqtt.stop();
+    for (auto& entry : waveforms) entry.channel->stop();
+
+    const auto counters = fake_broker::counters();
+    {
+        std::lock_guard<std::mutex> lock(observer.mtx);
+
+        CHECK_MSG(observer.event_order_errors == 0, "%llu events out of order", static_cast<unsigned long long>(observer.event_order_errors));
+        CHECK(observer.events > 0);
+        CHECK(observer.snippets > 0);
+        CHECK(observer.last_status_state == "offline");
+        CHECK(counters.clean_disconnects == 1);
+
+        CHECK(!observer.last_health.empty());
+        if (!observer.last_health.empty()) {
+            const auto health = nlohmann::json::parse(observer.last_health);
+            CHECK(health["counters"]["events_dropped"].get<std::uint64_t>() == 0);
+        }
+    }
+
+    // memory must plateau: compare the start and the end of the post-warmup samples
+    std::int64_t growth_kb = 0;
+    if (rss_kb.size() >= 6) {
+        const auto first = *std::min_element(rss_kb.begin(), rss_kb.begin() + 3);
+        const auto last = *std::max_element(rss_kb.end() - 3, rss_kb.end());
+        growth_kb = static_cast<std::int64_t>(last) - static_cast<std::int64_t>(first);
+        CHECK_MSG(growth_kb <= opts.max_rss_growth_kb, "RSS grew by %lld KiB after warmup (%llu -> %llu)",
+                  static_cast<long long>(growth_kb), static_cast<unsigned long long>(first), static_cast<unsigned long long>(last));
+    } else {
+        CHECK_MSG(rss_kb.size() >= 6, "run too short for an RSS trend (%zu samples)", rss_kb.size());
+    }
+
+    std::printf("soak: %.0f s, %llu cycles, %llu faults, %llu connect attempts (%llu by the library loop), %llu publishes, %llu events, RSS %+lld KiB after warmup\n",
+                ms_between(start, Clock::now()) / 1000.0,
+                static_cast<unsigned long long>(cycles),
+                static_cast<unsigned long long>(faults),
+                static_cast<unsigned long long>(counters.attempts),
+                static_cast<unsigned long long>(counters.library_reconnects),
+                static_cast<unsigned long long>(counters.publishes),
+                static_cast<unsigned long long>(observer.events),
+                static_cast<long long>(growth_kb));
+    return test::exit_code();
+}
@@ -0,0 +1,175 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "check.h"
+#include "logger.h"
+#include "systemd_notify.h"
+
+// Plays the service manager: binds the datagram socket named by NOTIFY_SOCKET and checks
+// what SystemdNotifier sends to it.
+
+namespace {
+
+    using Clock = SystemdNotifier::Clock;
+    using std::chrono::milliseconds;
+
+    class FakeServiceManager {
+        public:
+            // `name` starting with '@' binds in the abstract namespace, like systemd's own socket.
+            explicit FakeServiceManager(const std::string& name) : name_(name) {
+                fd_ = ::socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+                sockaddr_un addr {};
+                addr.sun_family = AF_UNIX;
+                std::memcpy(addr.sun_path, name.data(), name.size());
+                if (addr.sun_path[0] == '@') addr.sun_path[0] = '\0';
+                else ::unlink(name.c_str());
+                const auto len = static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) + name.size());
+                if (fd_ < 0 || ::bind(fd_, reinterpret_cast<const sockaddr*>(&addr), len) != 0) {
+                    std::perror("bind notify socket");
+                    std::exit(1);
+                }
+            }
+
+            ~FakeServiceManager() {
+                ::close(fd_);
+                if (name_[0] != '@') ::unlink(name_.c_str());
+            }
+
+            FakeServiceManager(const FakeServiceManager&) = delete;
+            FakeServiceManager& operator = (const FakeServiceManager&) = delete;
+
+            std::optional<std::string> receive() {
+                char buf[512];
+                const ssize_t n = ::recv(fd_, buf, sizeof(buf), 0);
+                if (n < 0) return std::nullopt;
+                return std::string(buf, static_cast<std::size_t>(n));
+            }
+
+            int pending() {
+                int count = 0;
+                while (receive()) ++count;
+                return count;
+            }
+
+        private:
+            std::string name_;
+            int fd_ = -1;
+    };
+
+    void clear_env() {
+        ::unsetenv("NOTIFY_SOCKET");
+        ::unsetenv("WATCHDOG_USEC");
+        ::unsetenv("WATCHDOG_PID");
+    }
+
+    void test_disabled_without_notify_socket() {
+        clear_env();
+        SystemdNotifier notifier;
+        CHECK(!notifier.enabled());
+        CHECK(!notifier.watchdog_enabled());
+        CHECK(!notifier.notify("READY=1"));
+    }
+
+    void test_rejects_relative_path() {
+        clear_env();
+        ::setenv("NOTIFY_SOCKET", "relative/notify.sock", 1);
+        SystemdNotifier notifier;
+        CHECK(!notifier.enabled());
+    }
+
+    void test_ready_status_stopping(const std::string& socket_name) {
+        clear_env();
+        FakeServiceManager manager(socket_name);
+        ::setenv("NOTIFY_SOCKET", socket_name.c_str(), 1);
+
+        SystemdNotifier notifier;
+        CHECK(notifier.enabled());
+        CHECK(!notifier.watchdog_enabled());
+
+        notifier.status("connecting to localhost:1883");
+        CHECK(manager.receive() == std::string("STATUS=connecting to localhost:1883"));
+
+        notifier.ready();
+        CHECK(manager.receive() == std::string("READY=1"));
+        notifier.ready();
+        CHECK_MSG(manager.pending() == 0, "READY=1 sent twice on %s", socket_name.c_str());
+
+        // watchdog() is a no-op without WATCHDOG_USEC
+        notifier.watchdog(Clock::now());
+        CHECK(manager.pending() == 0);
+
+        notifier.stopping();
+        CHECK(manager.receive() == std::string("STOPPING=1"));
+    }
+
+    void test_watchdog_rate_limit(const std::string& socket_name) {
+        clear_env();
+        FakeServiceManager manager(socket_name);
+        ::setenv("NOTIFY_SOCKET", socket_name.c_str(), 1);
+        ::setenv("WATCHDOG_USEC", "1000000", 1);
+        ::setenv("WATCHDOG_PID", std::to_string(getpid()).c_str(), 1);
+
+        SystemdNotifier notifier;
+        CHECK(notifier.watchdog_enabled());
+
+        // a 1 s timeout means one ping per 500 ms, however often the loop calls in
+        const auto t0 = Clock::now();
+        notifier.watchdog(t0);
+        CHECK(manager.receive() == std::string("WATCHDOG=1"));
+
+        for (int ms = 10; ms < 500; ms += 10) notifier.watchdog(t0 + milliseconds(ms));
+        CHECK_MSG(manager.pending() == 0, "watchdog pinged before WATCHDOG_USEC/2");
+
+        notifier.watchdog(t0 + milliseconds(500));
+        CHECK(manager.receive() == std::string("WATCHDOG=1"));
+
+        // 10 s of 1 ms loop iterations -> 20 pings
+        int pings = 0;
+        for (int ms = 501; ms <= 10500; ++ms) {
+            notifier.watchdog(t0 + milliseconds(ms));
+            pings += manager.pending();
+        }
+        CHECK_MSG(pings == 20, "expected 20 pings in 10 s, got %d", pings);
+    }
+
+    void test_watchdog_for_other_pid(const std::string& socket_name) {
+        clear_env();
+        FakeServiceManager manager(socket_name);
+        ::setenv("NOTIFY_SOCKET", socket_name.c_str(), 1);
+        ::setenv("WATCHDOG_USEC", "1000000", 1);
+        ::setenv("WATCHDOG_PID", std::to_string(getpid() + 1).c_str(), 1);
+
+        SystemdNotifier notifier;
+        CHECK(notifier.enabled());
+        CHECK(!notifier.watchdog_enabled());
+        notifier.watchdog(Clock::now());
+        CHECK(manager.pending() == 0);
+    }
+
+} // namespace
+
+int main() {
+    logger::set_level(logger::Level::Off);
+
+    const std::string pid = std::to_string(getpid());
+    const std::string path_socket = "/tmp/telemetry-notify-test-" + pid + ".sock";
+    const std::string abstract_socket = "@telemetry-notify-test-" + pid;
+
+    test_disabled_without_notify_socket();
+    test_rejects_relative_path();
+    test_ready_status_stopping(path_socket);
+    test_ready_status_stopping(abstract_socket);
+    test_watchdog_rate_limit(path_socket);
+    test_watchdog_rate_limit(abstract_socket);
+    test_watchdog_for_other_pid(path_socket);
+
+    clear_env();
+    return test::exit_code();
+}
@@ -0,0 +1,127 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include <openssl/evp.h>
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+
+#include "check.h"
+#include "logger.h"
+#include "tls_session.h"
+
+// TlsSessionCache against an in-process OpenSSL server with a self-signed certificate: the first
+// handshake is full, the next ones resume the session the cache re-applies from its info callback,
+// and the reported handshake time drops.
+
+namespace {
+
+    // RSA signing makes a full handshake clearly more expensive than a resumed one
+    struct Server {
+        SSL_CTX* ctx = nullptr;
+
+        Server() {
+            EVP_PKEY* key = EVP_RSA_gen(2048);
+            X509* cert = X509_new();
+            X509_set_version(cert, 2);
+            ASN1_INTEGER_set(X509_get_serialNumber(cert), 1);
+            X509_gmtime_adj(X509_getm_notBefore(cert), 0);
+            X509_gmtime_adj(X509_getm_notAfter(cert), 3600);
+            X509_NAME* name = X509_get_subject_name(cert);
+            X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, reinterpret_cast<const unsigned char*>("localhost"), -1, -1, 0);
+            X509_set_issuer_name(cert, name);
+            X509_set_pubkey(cert, key);
+            X509_sign(cert, key, EVP_sha256());
+
+            ctx = SSL_CTX_new(TLS_server_method());
+            SSL_CTX_use_certificate(ctx, cert);
+            SSL_CTX_use_PrivateKey(ctx, key);
+            X509_free(cert);
+            EVP_PKEY_free(key);
+        }
+
+        ~Server() { SSL_CTX_free(ctx); }
+    };
+
+    // One connection over a socketpair. The server sends a byte after the handshake so the client
+    // reads past it and picks up the TLS 1.3 session tickets, as a long-lived MQTT connection would.
+    // Returns whether the client side resumed a session.
+    bool connect_once(Server& server, TlsSessionCache& cache) {
+        int sv[2];
+        if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sv) != 0) return false;
+
+        std::thread peer([&server, fd = sv[1]] {
+            SSL* ssl = SSL_new(server.ctx);
+            SSL_set_fd(ssl, fd);
+            if (SSL_accept(ssl) == 1) {
+                const char byte = 'x';
+                SSL_write(ssl, &byte, 1);
+                char buf[1];
+                (void)SSL_read(ssl, buf, 1); // until the client closes
+            }
+            SSL_free(ssl);
+            ::close(fd);
+        });
+
+        SSL* ssl = SSL_new(cache.ctx());
+        SSL_set_fd(ssl, sv[0]);
+        bool reused = false;
+        if (SSL_connect(ssl) == 1) {
+            char buf[1];
+            CHECK(SSL_read(ssl, buf, 1) == 1);
+            reused = SSL_session_reused(ssl) == 1;
+            SSL_shutdown(ssl);
+        } else {
+            CHECK_MSG(false, "TLS handshake with the test server failed");
+        }
+        SSL_free(ssl);
+        ::close(sv[0]);
+        peer.join();
+        return reused;
+    }
+
+    void test_resumption() {
+        Server server;
+        constexpr int kRounds = 5;
+
+        // full handshakes: a fresh cache every time has nothing to offer
+        std::vector<std::uint64_t> full_us;
+        for (int i = 0; i < kRounds; ++i) {
+            TlsSessionCache fresh;
+            CHECK(!connect_once(server, fresh));
+            CHECK(fresh.handshakes() == 1 && fresh.resumed() == 0);
+            full_us.push_back(fresh.last_handshake_us());
+        }
+
+        TlsSessionCache cache;
+        CHECK_MSG(!connect_once(server, cache), "first connection resumed a session it never had");
+        std::vector<std::uint64_t> resumed_us;
+        for (int i = 0; i < kRounds; ++i) {
+            CHECK_MSG(connect_once(server, cache), "connection %d did not resume", i + 2);
+            resumed_us.push_back(cache.last_handshake_us());
+        }
+        CHECK(cache.handshakes() == kRounds + 1);
+        CHECK(cache.resumed() == kRounds);
+
+        // minimums, so a descheduled handshake on a busy host does not decide the comparison
+        const auto full = *std::min_element(full_us.begin(), full_us.end());
+        const auto resumed = *std::min_element(resumed_us.begin(), resumed_us.end());
+        CHECK_MSG(resumed < full, "resumed handshake %llu us, full %llu us", static_cast<unsigned long long>(resumed),
+                  static_cast<unsigned long long>(full));
+        std::printf("tls handshake: full %llu us, resumed %llu us\n", static_cast<unsigned long long>(full),
+                    static_cast<unsigned long long>(resumed));
+    }
+
+} // namespace
+
+int main() {
+    logger::set_level(logger::Level::Off);
+
+    test_resumption();
+
+    return test::exit_code();
+}